@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "sim_elf.h"
+#include "avr_eeprom.h"
+#include "avr_ioport.h"
+#include "avr_timer.h"
+
+#include "bench_sim.h"
+
+// DeviceSettings as the AVR stores it: little-endian, no padding
+static uint8_t packSettings(const DeviceSettings &settings, uint8_t *out) {
+  uint8_t n = 0;
+  out[n++] = EEPROM_SETTINGS_SIGNATURE & 0xFF;
+  out[n++] = EEPROM_SETTINGS_SIGNATURE >> 8;
+  uint8_t sizeAt = n++;
+  out[n++] = settings.reportMinInterval & 0xFF;
+  out[n++] = settings.reportMinInterval >> 8;
+  out[n++] = settings.reportKeepAlive & 0xFF;
+  out[n++] = settings.reportKeepAlive >> 8;
+  memcpy(&out[n], settings.filterCutoff, 16);
+  n += 16;
+  memcpy(&out[n], settings.filterBeta, 16);
+  n += 16;
+  for (uint8_t i = 0; i < 16; i++) {
+    const ChannelCalibration &cal = settings.calibration[i];
+    out[n++] = cal.min & 0xFF;
+    out[n++] = cal.min >> 8;
+    out[n++] = cal.center & 0xFF;
+    out[n++] = cal.center >> 8;
+    out[n++] = cal.max & 0xFF;
+    out[n++] = cal.max >> 8;
+    out[n++] = cal.deadband;
+    out[n++] = cal.expo;
+    out[n++] = cal.reverse;
+  }
+  out[sizeAt] = n;
+  return n;
+}
+
+avr_t *loadFirmware(const char *path, const JoystickConfig &cfg, const DeviceSettings *settings) {
+  elf_firmware_t firmware;
+  memset(&firmware, 0, sizeof(firmware));
+  if (elf_read_firmware(path, &firmware) != 0) {
+    fprintf(stderr, "bench: cannot read %s\n", path);
+    return nullptr;
+  }
+  if (!firmware.mmcu[0]) strcpy(firmware.mmcu, "atmega32u4");
+  if (!firmware.frequency) firmware.frequency = 16000000;
+
+  avr_t *avr = avr_make_mcu_by_name(firmware.mmcu);
+  if (!avr) {
+    fprintf(stderr, "bench: simavr has no core for %s\n", firmware.mmcu);
+    return nullptr;
+  }
+  avr_init(avr);
+  avr_load_firmware(avr, &firmware);
+
+  // One record in slot 0 the way loadConfigFromEEPROM() expects it. Without
+  // settings the record stops after cfg and the firmware uses its defaults.
+  uint8_t eeprom[STORE_SLOT_SIZE];
+  memset(eeprom, 0xFF, sizeof(eeprom));
+  uint16_t length = sizeof(cfg);
+  memcpy(&eeprom[sizeof(StoreHeader)], &cfg, sizeof(cfg));
+  if (settings) length += packSettings(*settings, &eeprom[sizeof(StoreHeader) + sizeof(cfg)]);
+
+  uint8_t *header = eeprom;
+  header[0] = STORE_MAGIC & 0xFF;
+  header[1] = STORE_MAGIC >> 8;
+  header[2] = STORE_VERSION;
+  header[3] = 0;
+  header[4] = 1;                      // Sequence
+  header[5] = 0;
+  header[6] = length & 0xFF;
+  header[7] = length >> 8;
+  uint16_t crc = 0xFFFF;
+  for (uint16_t i = 0; i < 8; i++) {
+    crc = crc16Update(crc, header[i]);
+  }
+  for (uint16_t i = 0; i < length; i++) {
+    crc = crc16Update(crc, eeprom[sizeof(StoreHeader) + i]);
+  }
+  header[8] = crc & 0xFF;
+  header[9] = crc >> 8;
+
+  avr_eeprom_desc_t desc;
+  desc.ee = eeprom;
+  desc.offset = 0;
+  desc.size = sizeof(eeprom);
+  avr_ioctl(avr, AVR_IOCTL_EEPROM_SET, &desc);
+  return avr;
+}
+
+avr_cycle_count_t nsToCycles(avr_t *avr, uint64_t ns) {
+  return ns * avr->frequency / 1000000000ULL;
+}
+
+avr_irq_t *ppmInput(avr_t *avr, const BenchProtocol &protocol) {
+  if (protocol.id == PPM_CAPTURE) {
+    // Latches TCNT1 into ICR1 on the edge selected by ICES1, like ICP1 (PD4)
+    return avr_io_getirq(avr, AVR_IOCTL_TIMER_GETIRQ('1'), TIMER_IRQ_IN_ICP);
+  }
+  return avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('D'), 2);
+}
+
+bool runUntil(avr_t *avr, avr_cycle_count_t cycle) {
+  while (avr->cycle < cycle) {
+    int state = avr_run(avr);
+    if (state == cpu_Done || state == cpu_Crashed) return false;
+  }
+  return true;
+}
@@ -0,0 +1,23 @@
+#ifndef BENCH_SIM_H
+#define BENCH_SIM_H
+
+#include "sim_avr.h"
+#include "sim_irq.h"
+#include "config.h"
+#include "bench_streams.h"
+
+// simavr helpers shared by the harnesses
+
+// Load the firmware and preload EEPROM with cfg (and settings, if given) the way
+// loadConfigFromEEPROM() expects it
+avr_t *loadFirmware(const char *path, const JoystickConfig &cfg, const DeviceSettings *settings = nullptr);
+
+avr_cycle_count_t nsToCycles(avr_t *avr, uint64_t ns);
+
+// Where BENCH_EVENT_PIN events go: INT2 (pin 0), or the Timer1 input capture for ppm_icp
+avr_irq_t *ppmInput(avr_t *avr, const BenchProtocol &protocol);
+
+// Run the core up to the given cycle, false if it stopped or crashed
+bool runUntil(avr_t *avr, avr_cycle_count_t cycle);
+
+#endif // BENCH_SIM_H
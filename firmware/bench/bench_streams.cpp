@@ -0,0 +1,209 @@
+#include <string.h>
+#include "bench_streams.h"
+
+const BenchProtocol benchProtocols[] = {
+  // name     id     ns/byte  frame period (us)
+  {"ibus",  IBUS,   86806,  7000},  // 115200 8N1
+  {"sbus",  SBUS,  120000, 14000},  // 100000 8E2
+  {"crsf",  CRSF,   23810,  4000},  // 420000 8N1
+  {"dsmx",  DSMX,   86806, 11000},  // 115200 8N1
+  {"dsm2",  DSM2,   86806, 22000},
+  {"fport", FPORT,  86806,  9000},
+  {"ppm",   PPM,  1000000, 22500},  // 8 channels, 1000-2000us pulses
+  {"ppm_icp", PPM_CAPTURE, 1000000, 22500}, // Same train on pin 4
+  {nullptr, 0, 0, 0},
+};
+
+void benchConfig(JoystickConfig *cfg, uint8_t protocol) {
+  benchMappings[0].apply(cfg);
+  cfg->protocol = protocol;
+}
+
+// Mirrors generateDefaultConfig(): five axes and three buttons
+static void mapDefault(JoystickConfig *cfg) {
+  memset(cfg, 0, sizeof(*cfg));
+  cfg->x_axis = 1;
+  cfg->y_axis = 2;
+  cfg->ry_axis = 3;
+  cfg->rx_axis = 4;
+  cfg->rz_axis = 7;
+  cfg->buttons[0] = 5;
+  cfg->buttons[1] = 6;
+  cfg->buttons[2] = 8;
+}
+
+// One stick, the smallest report
+static void mapMinimal(JoystickConfig *cfg) {
+  memset(cfg, 0, sizeof(*cfg));
+  cfg->x_axis = 1;
+  cfg->y_axis = 2;
+}
+
+// Every axis mapped
+static void mapFull(JoystickConfig *cfg) {
+  memset(cfg, 0, sizeof(*cfg));
+  uint8_t *axes = &cfg->x_axis;
+  for (int i = 0; i < 11; i++) {
+    axes[i] = i + 1;
+  }
+}
+
+// Sim cockpit: four axes, all 32 buttons and both hats
+static void mapCockpit(JoystickConfig *cfg) {
+  memset(cfg, 0, sizeof(*cfg));
+  cfg->x_axis = 1;
+  cfg->y_axis = 2;
+  cfg->rudder = 4;
+  cfg->throttle = 3;
+  for (int i = 0; i < 32; i++) {
+    cfg->buttons[i] = 5 + i % 10;
+  }
+  cfg->hat_switch1 = 15;
+  cfg->hat_switch2 = 16;
+}
+
+const BenchMapping benchMappings[] = {
+  {"default", mapDefault},
+  {"minimal", mapMinimal},
+  {"full",    mapFull},
+  {"cockpit", mapCockpit},
+  {nullptr, nullptr},
+};
+
+// Stick values in us (1000-2000) that move every frame
+static void sweep(int frame, uint16_t channels[16]) {
+  for (int i = 0; i < 16; i++) {
+    channels[i] = 1000 + (frame * 37 + i * 61) % 1001;
+  }
+}
+
+// 16 x 11 bit little-endian bit stream used by SBUS, CRSF and FPORT
+static void pack11(const uint16_t channels[16], uint8_t out[22]) {
+  uint32_t bits = 0;
+  uint8_t count = 0;
+  uint8_t n = 0;
+  for (int i = 0; i < 16; i++) {
+    bits |= (uint32_t)(channels[i] & 0x7FF) << count;
+    count += 11;
+    while (count >= 8) {
+      out[n++] = bits & 0xFF;
+      bits >>= 8;
+      count -= 8;
+    }
+  }
+}
+
+// 1000-2000us to the 172-1811 range SBUS, CRSF and FPORT carry
+static void toCrsfRange(const uint16_t us[16], uint16_t out[16]) {
+  for (int i = 0; i < 16; i++) {
+    out[i] = 172 + (uint32_t)(us[i] - 1000) * 1639 / 1000;
+  }
+}
+
+static uint8_t buildIBus(const uint16_t us[16], uint8_t *frame) {
+  frame[0] = 0x20;
+  frame[1] = 0x40;
+  for (int i = 0; i < 14; i++) {
+    frame[2 + i * 2] = us[i] & 0xFF;
+    frame[3 + i * 2] = us[i] >> 8;
+  }
+  uint16_t checksum = 0xFFFF;
+  for (int i = 0; i < 30; i++) checksum -= frame[i];
+  frame[30] = checksum & 0xFF;
+  frame[31] = checksum >> 8;
+  return 32;
+}
+
+static uint8_t buildSBUS(const uint16_t us[16], uint8_t *frame) {
+  uint16_t raw[16];
+  toCrsfRange(us, raw);
+  frame[0] = 0x0F;
+  pack11(raw, &frame[1]);
+  frame[23] = 0x00; // Flags: no frame lost, no failsafe
+  frame[24] = 0x00;
+  return 25;
+}
+
+static uint8_t buildCRSF(const uint16_t us[16], uint8_t *frame) {
+  uint16_t raw[16];
+  toCrsfRange(us, raw);
+  frame[0] = 0xC8;
+  frame[1] = 24;   // Type + 22 payload bytes + CRC
+  frame[2] = 0x16; // RC channels packed
+  pack11(raw, &frame[3]);
+  // CRC8 DVB-S2 over type and payload, computed bit by bit so it does not
+  // share the firmware's lookup table
+  uint8_t crc = 0;
+  for (int i = 2; i < 25; i++) {
+    crc ^= frame[i];
+    for (int bit = 0; bit < 8; bit++) crc = (crc & 0x80) ? (crc << 1) ^ 0xD5 : crc << 1;
+  }
+  frame[25] = crc;
+  return 26;
+}
+
+static uint8_t buildDSM(const uint16_t us[16], int frameNumber, bool is11bit, uint8_t *frame) {
+  frame[0] = 0;    // Fades
+  frame[1] = is11bit ? 0xB2 : 0x01;
+  // Alternate between channels 1-7 and 8-14 like a 2-frame DSM transmitter
+  int first = (frameNumber & 1) ? 7 : 0;
+  for (int i = 0; i < 7; i++) {
+    uint16_t channel = first + i;
+    uint16_t word;
+    if (is11bit) word = (channel << 11) | ((uint32_t)(us[channel] - 1000) * 2047 / 1000);
+    else word = (channel << 10) | ((uint32_t)(us[channel] - 1000) * 1023 / 1000);
+    frame[2 + i * 2] = word >> 8;
+    frame[3 + i * 2] = word & 0xFF;
+  }
+  return 16;
+}
+
+static uint8_t buildFPORT(const uint16_t us[16], uint8_t *frame) {
+  uint16_t raw[16];
+  toCrsfRange(us, raw);
+  frame[0] = 0x7E;
+  frame[1] = 0x18;
+  frame[2] = 0x00; // RC channels
+  pack11(raw, &frame[3]);
+  frame[25] = 0x00; // Flags
+  uint8_t crc = 0;  // Matches the check in readFPORT()
+  for (int i = 3; i < 26; i++) crc ^= frame[i];
+  frame[26] = crc;
+  frame[27] = 0x7E;
+  return 28;
+}
+
+void buildStream(const BenchProtocol &protocol, int frames, std::vector<BenchEvent> *events) {
+  uint16_t us[16];
+  uint8_t frame[32];
+
+  for (int f = 0; f < frames; f++) {
+    uint64_t frameStart = (uint64_t)f * protocol.framePeriodUs * 1000;
+    sweep(f, us);
+
+    if (protocol.id == PPM || protocol.id == PPM_CAPTURE) {
+      // Rising edge at the start of every channel slot plus one closing the
+      // last channel, 300us high pulses, remaining time is the sync gap
+      uint64_t t = frameStart;
+      for (int i = 0; i <= 8; i++) {
+        events->push_back({t, BENCH_EVENT_PIN, 1, i == 8});
+        events->push_back({t + 300000, BENCH_EVENT_PIN, 0, false});
+        if (i < 8) t += (uint64_t)us[i] * 1000;
+      }
+      continue;
+    }
+
+    uint8_t length;
+    switch (protocol.id) {
+      case SBUS: length = buildSBUS(us, frame); break;
+      case CRSF: length = buildCRSF(us, frame); break;
+      case DSMX: length = buildDSM(us, f, true, frame); break;
+      case DSM2: length = buildDSM(us, f, false, frame); break;
+      case FPORT: length = buildFPORT(us, frame); break;
+      default: length = buildIBus(us, frame); break;
+    }
+    for (uint8_t i = 0; i < length; i++) {
+      events->push_back({frameStart + (uint64_t)i * protocol.byteTimeNs, BENCH_EVENT_BYTE, frame[i], i == length - 1});
+    }
+  }
+}
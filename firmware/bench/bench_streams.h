@@ -0,0 +1,46 @@
+#ifndef BENCH_STREAMS_H
+#define BENCH_STREAMS_H
+
+#include <stdint.h>
+#include <vector>
+#include "config.h"
+
+// Synthetic receiver streams for the simavr harnesses
+
+#define BENCH_EVENT_BYTE 0 // value is the byte to push into USART1
+#define BENCH_EVENT_PIN  1 // value is the new level of the PPM pin (pin 0, or pin 4 for ppm_icp)
+
+struct BenchEvent {
+  uint64_t timeNs;   // Offset from the start of the stream
+  uint8_t kind;
+  uint8_t value;
+  bool frameEnd;     // Last byte (or edge) of a frame
+};
+
+struct BenchProtocol {
+  const char *name;
+  uint8_t id;
+  uint32_t byteTimeNs;   // Wire time per byte (PPM: shortest channel pulse)
+  uint32_t framePeriodUs;
+};
+
+extern const BenchProtocol benchProtocols[]; // Terminated by a null name
+
+struct BenchMapping {
+  const char *name;
+  void (*apply)(JoystickConfig *cfg); // Clears cfg and sets the mapping, not the protocol
+};
+
+extern const BenchMapping benchMappings[]; // First entry is the default, terminated by a null name
+
+inline bool isPPM(const BenchProtocol &protocol) {
+  return protocol.id == PPM || protocol.id == PPM_CAPTURE;
+}
+
+// Fill cfg with the default mapping for the given protocol
+void benchConfig(JoystickConfig *cfg, uint8_t protocol);
+
+// Append frames of sweeping stick values to events
+void buildStream(const BenchProtocol &protocol, int frames, std::vector<BenchEvent> *events);
+
+#endif // BENCH_STREAMS_H
@@ -0,0 +1,53 @@
+#!/bin/bash
+# Run the decoder benchmark (run_bench.sh) on two revisions and print the
+# cycle counts side by side. Each revision is checked out into a temporary
+# git worktree and built there, so the working tree is left alone. The raw
+# results are kept as bench_<rev>.jsonl (or in the directory given as third
+# argument).
+#
+#   ./bench/compare_bench.sh <base-rev> [<rev>]     # <rev> defaults to HEAD
+#
+# Requires PlatformIO, simavr and python3.
+
+set -e -o pipefail
+
+cd "$(dirname "$0")/.."
+BASE="${1:?usage: $0 <base-rev> [<rev>] [<out-dir>]}"
+REV="${2:-HEAD}"
+OUT_DIR="$(cd "${3:-.}" && pwd)"
+TMP=$(mktemp -d)
+trap 'git worktree remove --force "$TMP/base" 2>/dev/null; git worktree remove --force "$TMP/rev" 2>/dev/null; rm -rf "$TMP"' EXIT
+
+run() {
+  local rev=$1 dir=$2 out=$3
+  git worktree add --detach "$dir" "$rev" >/dev/null
+  (cd "$dir/firmware" && ./bench/run_bench.sh "$out" >/dev/null)
+}
+
+BASE_OUT="$OUT_DIR/bench_$(git rev-parse --short "$BASE").jsonl"
+REV_OUT="$OUT_DIR/bench_$(git rev-parse --short "$REV").jsonl"
+run "$BASE" "$TMP/base" "$BASE_OUT"
+run "$REV" "$TMP/rev" "$REV_OUT"
+
+python3 - "$BASE_OUT" "$REV_OUT" <<'EOF'
+import json, sys
+
+def load(path):
+    with open(path) as f:
+        return {(r["protocol"], r.get("filter", 0)): r for r in map(json.loads, f) if r}
+
+base, rev = load(sys.argv[1]), load(sys.argv[2])
+fields = ["cycles_per_frame", "cycles_read", "cycles_map"]
+print("%-8s %6s" % ("protocol", "filter") + "".join(" %24s" % f for f in fields))
+for key in sorted(base.keys() & rev.keys()):
+    cells = []
+    for field in fields:
+        a, b = base[key].get(field), rev[key].get(field)
+        if not a or not b:
+            cells.append(" %24s" % "-")
+            continue
+        a, b = a["mean"], b["mean"]
+        change = (b - a) * 100.0 / a if a else 0.0
+        cells.append(" %24s" % ("%.1f -> %.1f (%+.1f%%)" % (a, b, change)))
+    print("%-8s %6d" % key + "".join(cells))
+EOF
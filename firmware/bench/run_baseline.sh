@@ -0,0 +1,16 @@
+#!/bin/bash
+# Run the simavr benchmarks and write their results to bench/results/, the
+# baseline that is committed with the firmware. Later runs are compared
+# against it with git diff. Each file's label field holds git describe of the
+# tree the numbers came from, so run it on a clean checkout.
+#
+# Requires PlatformIO and simavr (libsimavr-dev / simavr from Homebrew).
+
+set -e -o pipefail
+
+cd "$(dirname "$0")/.."
+OUT_DIR=bench/results
+mkdir -p "$OUT_DIR"
+
+./bench/run_bench.sh "$OUT_DIR/bench_results.jsonl"
+./bench/run_latency.sh "$OUT_DIR/latency_results.jsonl"
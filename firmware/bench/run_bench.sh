@@ -0,0 +1,24 @@
+#!/bin/bash
+# Build the [env:bench] firmware and the simavr harness, then run the decoder
+# benchmark for every protocol, once plain and once with the channel filter on
+# all 16 channels. Results are written as JSON lines to bench_results.jsonl
+# (or the file given as first argument).
+#
+# Requires PlatformIO and simavr (libsimavr-dev / simavr from Homebrew).
+
+set -e
+
+cd "$(dirname "$0")/.."
+OUT="${1:-bench_results.jsonl}"
+BUILD_DIR=.pio/build/bench
+
+pio run -e bench
+
+SIMAVR_FLAGS=$(pkg-config --cflags --libs simavr 2>/dev/null || echo "-I/usr/include/simavr -lsimavr -lelf")
+c++ -O2 -std=c++11 -Iinclude -Ibench \
+    bench/simbench.cpp bench/bench_sim.cpp bench/bench_streams.cpp \
+    $SIMAVR_FLAGS -o "$BUILD_DIR/simbench"
+
+LABEL=$(git describe --always --dirty 2>/dev/null || echo unknown)
+"$BUILD_DIR/simbench" "$BUILD_DIR/firmware.elf" --label "$LABEL" | tee "$OUT"
+"$BUILD_DIR/simbench" "$BUILD_DIR/firmware.elf" --label "$LABEL" --filter 16 | tee -a "$OUT"
@@ -0,0 +1,24 @@
+#!/bin/bash
+# Build the [env:latency] firmware and the simavr detection harness, then time
+# how long protocol auto detection takes to lock onto every protocol, at boot
+# and after a signal loss. Results are written as JSON lines to
+# detect_results.jsonl (or the file given as first argument). Fails when a
+# stream is detected as another protocol or does not lock within the bound.
+#
+# Requires PlatformIO and simavr (libsimavr-dev / simavr from Homebrew).
+
+set -e -o pipefail
+
+cd "$(dirname "$0")/.."
+OUT="${1:-detect_results.jsonl}"
+BUILD_DIR=.pio/build/latency
+
+pio run -e latency
+
+SIMAVR_FLAGS=$(pkg-config --cflags --libs simavr 2>/dev/null || echo "-I/usr/include/simavr -lsimavr -lelf")
+c++ -O2 -std=c++11 -Iinclude -Ibench \
+    bench/simdetect.cpp bench/bench_sim.cpp bench/bench_streams.cpp \
+    $SIMAVR_FLAGS -o "$BUILD_DIR/simdetect"
+
+LABEL=$(git describe --always --dirty 2>/dev/null || echo unknown)
+"$BUILD_DIR/simdetect" "$BUILD_DIR/firmware.elf" --label "$LABEL" | tee "$OUT"
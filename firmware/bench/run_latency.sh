@@ -0,0 +1,22 @@
+#!/bin/bash
+# Build the [env:latency] firmware and the simavr harness, then measure the
+# wire-to-HID latency for every protocol and mapping. Results are written as
+# JSON lines to latency_results.jsonl (or the file given as first argument).
+#
+# Requires PlatformIO and simavr (libsimavr-dev / simavr from Homebrew).
+
+set -e
+
+cd "$(dirname "$0")/.."
+OUT="${1:-latency_results.jsonl}"
+BUILD_DIR=.pio/build/latency
+
+pio run -e latency
+
+SIMAVR_FLAGS=$(pkg-config --cflags --libs simavr 2>/dev/null || echo "-I/usr/include/simavr -lsimavr -lelf")
+c++ -O2 -std=c++11 -Iinclude -Ibench \
+    bench/simlatency.cpp bench/bench_sim.cpp bench/bench_streams.cpp \
+    $SIMAVR_FLAGS -o "$BUILD_DIR/simlatency"
+
+LABEL=$(git describe --always --dirty 2>/dev/null || echo unknown)
+"$BUILD_DIR/simlatency" "$BUILD_DIR/firmware.elf" --label "$LABEL" | tee "$OUT"
@@ -0,0 +1,23 @@
+#!/bin/bash
+# Build the [env:bench] firmware and the simavr PPM harness, then check both
+# PPM engines against a train of known pulse widths. Results are written as
+# JSON lines to ppm_results.jsonl (or the file given as first argument). Fails
+# when the input capture engine does not decode every width exactly.
+#
+# Requires PlatformIO and simavr (libsimavr-dev / simavr from Homebrew).
+
+set -e -o pipefail
+
+cd "$(dirname "$0")/.."
+OUT="${1:-ppm_results.jsonl}"
+BUILD_DIR=.pio/build/bench
+
+pio run -e bench
+
+SIMAVR_FLAGS=$(pkg-config --cflags --libs simavr 2>/dev/null || echo "-I/usr/include/simavr -lsimavr -lelf")
+c++ -O2 -std=c++11 -Iinclude -Ibench \
+    bench/simppm.cpp bench/bench_sim.cpp bench/bench_streams.cpp \
+    $SIMAVR_FLAGS -o "$BUILD_DIR/simppm"
+
+LABEL=$(git describe --always --dirty 2>/dev/null || echo unknown)
+"$BUILD_DIR/simppm" "$BUILD_DIR/firmware.elf" --label "$LABEL" | tee "$OUT"
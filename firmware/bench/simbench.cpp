@@ -0,0 +1,187 @@
+// Cycle-accurate decoder benchmark
+//
+// Loads the [env:bench] firmware into simavr once per protocol, preloads its
+// EEPROM with a configuration for that protocol, then plays a synthetic
+// receiver stream into USART1 (or PPM edges into INT2) at wire speed. Every
+// marker the firmware writes to GPIOR0 is timestamped with the simulated
+// cycle counter. One JSON object per protocol is printed to stdout.
+//
+// With --filter the channel filter runs on all 16 channels with that cutoff,
+// so its cost shows up in cycles_read and cycles_per_frame.
+//
+//   simbench <firmware.elf> [--protocol <name>] [--frames <n>] [--filter <cutoff>] [--label <rev>]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <vector>
+
+#include "sim_avr.h"
+#include "sim_irq.h"
+#include "avr_uart.h"
+#include "avr_ioport.h"
+#include "avr_timer.h"
+
+#include "config.h"
+#include "bench.h"
+#include "bench_sim.h"
+#include "bench_streams.h"
+
+struct Stat {
+  uint32_t count = 0;
+  uint64_t total = 0;
+  uint32_t min = UINT32_MAX;
+  uint32_t max = 0;
+
+  void add(uint32_t cycles) {
+    count++;
+    total += cycles;
+    if (cycles < min) min = cycles;
+    if (cycles > max) max = cycles;
+  }
+};
+
+struct Run {
+  avr_cycle_count_t decodeStart = 0;
+  avr_cycle_count_t mapStart = 0;
+  avr_cycle_count_t isrStart = 0;
+  uint32_t frameCycles = 0;   // Decode cycles accumulated since the last frame
+  bool ready = false;
+  Stat perCall;               // One readXxx() call after a receive interrupt
+  Stat perFrame;              // All decode work attributable to one frame
+  Stat map;                   // updateJoystickFromChannels()
+  Stat isr;                   // UART receive or PPM edge interrupt
+};
+
+static void onMarker(avr_t *avr, avr_io_addr_t addr, uint8_t v, void *param) {
+  Run *run = (Run *)param;
+  avr_cycle_count_t now = avr->cycle;
+
+  switch (v) {
+    case BENCH_READY:
+      run->ready = true;
+      break;
+    case BENCH_DECODE_START:
+      run->decodeStart = now;
+      break;
+    case BENCH_DECODE_END:
+    case BENCH_FRAME_END: {
+      uint32_t cycles = now - run->decodeStart;
+      run->perCall.add(cycles);
+      run->frameCycles += cycles;
+      if (v == BENCH_FRAME_END) {
+        run->perFrame.add(run->frameCycles);
+        run->frameCycles = 0;
+      }
+      break;
+    }
+    case BENCH_MAP_START:
+      run->mapStart = now;
+      break;
+    case BENCH_MAP_END:
+      run->map.add(now - run->mapStart);
+      break;
+    case BENCH_ISR_START:
+      run->isrStart = now;
+      break;
+    case BENCH_ISR_END: {
+      uint32_t cycles = now - run->isrStart;
+      run->isr.add(cycles);
+      run->frameCycles += cycles;
+      break;
+    }
+  }
+}
+
+static bool benchProtocol(const char *elf, const BenchProtocol &protocol, int frames, int filter, const char *label) {
+  JoystickConfig cfg;
+  benchConfig(&cfg, protocol.id);
+
+  // --filter turns the channel filter on for all 16 channels
+  DeviceSettings settings;
+  memset(&settings, 0, sizeof(settings));
+  settings.reportKeepAlive = DEFAULT_REPORT_KEEPALIVE;
+  memset(settings.filterCutoff, filter, sizeof(settings.filterCutoff));
+  memset(settings.filterBeta, DEFAULT_FILTER_BETA, sizeof(settings.filterBeta));
+  avr_t *avr = loadFirmware(elf, cfg, &settings);
+  if (!avr) return false;
+
+  Run run;
+  avr_register_io_write(avr, BENCH_MARK_IO_ADDR, onMarker, &run);
+
+  // Boot until the decoder is initialized
+  while (!run.ready) {
+    if (!runUntil(avr, avr->cycle + 1000)) return false;
+    if (avr->cycle > avr->frequency) {
+      fprintf(stderr, "simbench: %s never reached BENCH_READY\n", protocol.name);
+      return false;
+    }
+  }
+
+  std::vector<BenchEvent> events;
+  buildStream(protocol, frames, &events);
+
+  avr_irq_t *uartIn = avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('1'), UART_IRQ_INPUT);
+  avr_irq_t *ppmPin = ppmInput(avr, protocol);
+
+  avr_cycle_count_t start = avr->cycle;
+  for (const BenchEvent &event : events) {
+    if (!runUntil(avr, start + nsToCycles(avr, event.timeNs))) return false;
+    if (event.kind == BENCH_EVENT_BYTE) avr_raise_irq(uartIn, event.value);
+    else avr_raise_irq(ppmPin, event.value);
+  }
+  // Let the last frame drain
+  runUntil(avr, avr->cycle + nsToCycles(avr, 5000000));
+
+  uint32_t budget = nsToCycles(avr, protocol.byteTimeNs);
+  const Stat &perByte = run.isr;
+
+  printf("{\"label\": \"%s\", \"protocol\": \"%s\", \"filter\": %d, \"f_cpu\": %lu, \"frames_sent\": %d, \"frames_decoded\": %u",
+         label, protocol.name, filter, (unsigned long)avr->frequency, frames, run.perFrame.count);
+  printf(", \"%s\": {\"count\": %u, \"min\": %u, \"mean\": %.1f, \"max\": %u}",
+         isPPM(protocol) ? "cycles_per_edge" : "cycles_per_byte",
+         perByte.count, perByte.count ? perByte.min : 0,
+         perByte.count ? (double)perByte.total / perByte.count : 0.0, perByte.max);
+  printf(", \"cycles_per_frame\": {\"min\": %u, \"mean\": %.1f, \"max\": %u}",
+         run.perFrame.count ? run.perFrame.min : 0,
+         run.perFrame.count ? (double)run.perFrame.total / run.perFrame.count : 0.0, run.perFrame.max);
+  printf(", \"cycles_map\": {\"min\": %u, \"mean\": %.1f, \"max\": %u}",
+         run.map.count ? run.map.min : 0,
+         run.map.count ? (double)run.map.total / run.map.count : 0.0, run.map.max);
+  printf(", \"cycles_read\": {\"min\": %u, \"mean\": %.1f, \"max\": %u}",
+         run.perCall.count ? run.perCall.min : 0,
+         run.perCall.count ? (double)run.perCall.total / run.perCall.count : 0.0, run.perCall.max);
+  printf(", \"budget_cycles_per_%s\": %u, \"headroom_pct\": %.1f}\n",
+         isPPM(protocol) ? "edge" : "byte", budget,
+         budget ? 100.0 * ((double)budget - perByte.max) / budget : 0.0);
+
+  avr_terminate(avr);
+  return true;
+}
+
+int main(int argc, char **argv) {
+  const char *elf = nullptr;
+  const char *only = nullptr;
+  const char *label = "";
+  int frames = 200;
+  int filter = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--protocol") && i + 1 < argc) only = argv[++i];
+    else if (!strcmp(argv[i], "--frames") && i + 1 < argc) frames = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--filter") && i + 1 < argc) filter = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--label") && i + 1 < argc) label = argv[++i];
+    else elf = argv[i];
+  }
+  if (!elf) {
+    fprintf(stderr, "usage: %s <firmware.elf> [--protocol <name>] [--frames <n>] [--filter <cutoff>] [--label <rev>]\n", argv[0]);
+    return 2;
+  }
+
+  bool ok = true;
+  for (const BenchProtocol *p = benchProtocols; p->name; p++) {
+    if (only && strcmp(only, p->name)) continue;
+    ok &= benchProtocol(elf, *p, frames, filter, label);
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,240 @@
+// Protocol auto detection benchmark
+//
+// Loads the [env:latency] firmware with the protocol set to auto, plays one
+// protocol's stream and times how long detection takes to lock onto it, read
+// back through the BENCH_PROTOCOL marker. Every run boots the firmware again
+// and starts the stream at a different point of the candidate cycle. After
+// the lock the stream stops until detection lets go (AUTO_RELOCK_MS), then
+// starts again, which times the relock after a signal loss.
+//
+// simavr hands USART1 every byte whatever baud rate and framing it is set to,
+// so the harness compares UBRR1 and UCSR1C with the stream's and, when they
+// do not match, feeds the UART pseudo random bytes at the rate it is set to
+// instead, like a receiver sampling at the wrong speed. PPM edges only reach
+// the pin the stream is wired to.
+//
+// One JSON object per protocol is printed to stdout. The exit status is 1 if a
+// stream was taken for another protocol or did not lock within AUTO_CYCLE_MS
+// plus AUTO_LOCK_FRAMES + 1 frame periods.
+//
+//   simdetect <firmware.elf> [--protocol <name>] [--runs <n>] [--label <rev>]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#include "sim_avr.h"
+#include "sim_irq.h"
+#include "avr_uart.h"
+
+#include "config.h"
+#include "bench.h"
+#include "bench_sim.h"
+#include "bench_streams.h"
+#include "rc_input.h"
+
+// USART1 registers in data space on the ATmega32U4
+#define UCSR1B_ADDR 0xC9
+#define UCSR1C_ADDR 0xCA
+#define UBRR1L_ADDR 0xCC
+#define UBRR1H_ADDR 0xCD
+#define RXEN1_BIT   0x10
+#define FORMAT_BITS 0x38 // UPM11, UPM10, USBS1
+
+#define LOCK_TIMEOUT_MS (3 * AUTO_CYCLE_MS)
+
+struct Run {
+  bool ready = false;
+  uint8_t protocol = 0;               // Last BENCH_PROTOCOL value
+  avr_cycle_count_t changed = 0;      // Cycle of that marker
+};
+
+static void onMarker(avr_t *avr, avr_io_addr_t addr, uint8_t v, void *param) {
+  Run *run = (Run *)param;
+
+  switch (v) {
+    case BENCH_READY:
+      run->ready = true;
+      break;
+    case BENCH_PROTOCOL:
+      run->protocol = avr->data[BENCH_DATA_LO_IO_ADDR];
+      run->changed = avr->cycle;
+      break;
+  }
+}
+
+// What halSerialBegin() programs for the protocol's UART
+static void wireSettings(avr_t *avr, const BenchProtocol &protocol, uint16_t *ubrr, uint8_t *format) {
+  uint32_t baud = 115200;
+  *format = 0x00;                     // 8N1
+  if (protocol.id == SBUS) {
+    baud = 100000;
+    *format = 0x28;                   // 8E2
+  } else if (protocol.id == CRSF) {
+    baud = 420000;
+  }
+  *ubrr = (avr->frequency / 4 / baud - 1) / 2;
+}
+
+struct Uart {
+  avr_irq_t *input;
+  uint16_t ubrr;                      // Stream's settings
+  uint8_t format;
+  avr_cycle_count_t nextGarbage = 0;
+  uint32_t seed = 0x2545F491;
+};
+
+// Deliver one byte of the stream, or what the UART makes of it at other settings
+static void uartByte(avr_t *avr, Uart *uart, uint8_t value) {
+  if (!(avr->data[UCSR1B_ADDR] & RXEN1_BIT)) return;
+  uint16_t ubrr = avr->data[UBRR1L_ADDR] | (avr->data[UBRR1H_ADDR] << 8);
+  uint8_t format = avr->data[UCSR1C_ADDR] & FORMAT_BITS;
+  if (ubrr == uart->ubrr && format == uart->format) {
+    avr_raise_irq(uart->input, value);
+    return;
+  }
+
+  // At most one byte per frame time of the rate USART1 runs at (U2X1 is set)
+  if (avr->cycle < uart->nextGarbage) return;
+  uint8_t bits = (format & 0x08) ? 12 : 10;
+  uart->nextGarbage = avr->cycle + (avr_cycle_count_t)bits * 8 * (ubrr + 1);
+  uart->seed ^= uart->seed << 13;
+  uart->seed ^= uart->seed >> 17;
+  uart->seed ^= uart->seed << 5;
+  avr_raise_irq(uart->input, uart->seed & 0xFF);
+}
+
+// Play the stream from cycle start until detection locks, the cycles it took
+// or -1 on a timeout. *frames gets the frames completed on the wire by then,
+// run->protocol tells what it locked onto.
+static int64_t playUntilLock(avr_t *avr, Run *run, const BenchProtocol &protocol, Uart *uart,
+                             avr_irq_t *ppmPin, avr_cycle_count_t start, int *frames) {
+  int streamFrames = LOCK_TIMEOUT_MS * 1000 / protocol.framePeriodUs + 1;
+  std::vector<BenchEvent> events;
+  buildStream(protocol, streamFrames, &events);
+
+  *frames = 0;
+  for (const BenchEvent &event : events) {
+    if (!runUntil(avr, start + nsToCycles(avr, event.timeNs))) return -1;
+    if (run->protocol) return run->changed - start;
+    if (event.kind == BENCH_EVENT_BYTE) uartByte(avr, uart, event.value);
+    else avr_raise_irq(ppmPin, event.value);
+    if (event.frameEnd) (*frames)++;
+  }
+  return -1;
+}
+
+static double cyclesToMs(avr_t *avr, uint64_t cycles) {
+  return cycles * 1000.0 / avr->frequency;
+}
+
+static void printStats(const char *name, std::vector<double> &values) {
+  std::sort(values.begin(), values.end());
+  if (values.empty()) {
+    printf(", \"%s\": null", name);
+    return;
+  }
+  printf(", \"%s\": {\"min\": %.1f, \"median\": %.1f, \"max\": %.1f}", name, values.front(), values[values.size() / 2], values.back());
+}
+
+static bool benchDetect(const char *elf, const BenchProtocol &protocol, int runs, const char *label, bool *passed) {
+  std::vector<double> lockMs, lockFrames;
+  std::vector<double> relockMs, relockFrames;
+  int wrong = 0;
+  int missed = 0;
+  double boundMs = AUTO_CYCLE_MS + (AUTO_LOCK_FRAMES + 1) * protocol.framePeriodUs / 1000.0;
+  uint32_t frequency = 0;
+
+  for (int r = 0; r < runs; r++) {
+    JoystickConfig cfg;
+    benchConfig(&cfg, AUTO);
+    avr_t *avr = loadFirmware(elf, cfg);
+    if (!avr) return false;
+    frequency = avr->frequency;
+
+    Run run;
+    avr_register_io_write(avr, BENCH_MARK_IO_ADDR, onMarker, &run);
+
+    while (!run.ready) {
+      if (!runUntil(avr, avr->cycle + 1000)) return false;
+      if (avr->cycle > avr->frequency) {
+        fprintf(stderr, "simdetect: %s never reached BENCH_READY\n", protocol.name);
+        return false;
+      }
+    }
+
+    Uart uart;
+    uart.input = avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('1'), UART_IRQ_INPUT);
+    wireSettings(avr, protocol, &uart.ubrr, &uart.format);
+    avr_irq_t *ppmPin = ppmInput(avr, protocol);
+
+    // Spread the stream starts over one candidate cycle, off the millisecond grid
+    uint64_t offsetNs = (uint64_t)r * AUTO_CYCLE_MS * 1000000ULL / runs + 137000;
+    for (int pass = 0; pass < 2; pass++) {
+      avr_cycle_count_t start = avr->cycle + nsToCycles(avr, offsetNs);
+      int frames;
+      int64_t cycles = playUntilLock(avr, &run, protocol, &uart, ppmPin, start, &frames);
+      if (cycles < 0) {
+        missed++;
+        break;
+      }
+      if (run.protocol != protocol.id) wrong++;
+      double ms = cyclesToMs(avr, cycles);
+      if (ms > boundMs) missed++;
+      (pass == 0 ? lockMs : relockMs).push_back(ms);
+      (pass == 0 ? lockFrames : relockFrames).push_back(frames);
+
+      // Signal loss: wait for detection to let go of the protocol
+      avr_cycle_count_t lost = avr->cycle;
+      while (run.protocol) {
+        if (!runUntil(avr, avr->cycle + 1000)) return false;
+        if (avr->cycle - lost > nsToCycles(avr, (AUTO_RELOCK_MS + 500) * 1000000ULL)) break;
+      }
+      if (run.protocol) {
+        fprintf(stderr, "simdetect: %s still locked after the signal stopped\n", protocol.name);
+        missed++;
+        break;
+      }
+    }
+    avr_terminate(avr);
+  }
+
+  printf("{\"label\": \"%s\", \"protocol\": \"%s\", \"f_cpu\": %lu, \"frame_period_us\": %u, \"runs\": %d",
+         label, protocol.name, (unsigned long)frequency, protocol.framePeriodUs, runs);
+  printStats("lock_frames", lockFrames);
+  printStats("lock_ms", lockMs);
+  printStats("relock_frames", relockFrames);
+  printStats("relock_ms", relockMs);
+  printf(", \"bound_ms\": %.1f, \"wrong\": %d, \"missed\": %d}\n", boundMs, wrong, missed);
+
+  if (wrong || missed) *passed = false;
+  return true;
+}
+
+int main(int argc, char **argv) {
+  const char *elf = nullptr;
+  const char *onlyProtocol = nullptr;
+  const char *label = "";
+  int runs = 10;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--protocol") && i + 1 < argc) onlyProtocol = argv[++i];
+    else if (!strcmp(argv[i], "--runs") && i + 1 < argc) runs = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--label") && i + 1 < argc) label = argv[++i];
+    else elf = argv[i];
+  }
+  if (!elf || runs < 1) {
+    fprintf(stderr, "usage: %s <firmware.elf> [--protocol <name>] [--runs <n>] [--label <rev>]\n", argv[0]);
+    return 2;
+  }
+
+  bool ok = true;
+  bool passed = true;
+  for (const BenchProtocol *p = benchProtocols; p->name; p++) {
+    if (onlyProtocol && strcmp(onlyProtocol, p->name)) continue;
+    ok &= benchDetect(elf, *p, runs, label, &passed);
+  }
+  return (ok && passed) ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+// Wire-to-HID latency benchmark
+//
+// Loads the [env:latency] firmware, which runs the real joystick mode loop
+// (LED updates included), once per protocol and mapping. A synthetic receiver
+// stream is played into USART1 (or PPM edges into INT2) at wire speed and the
+// harness timestamps BENCH_HID_SENT, written right after the HID sink copied
+// the report into its endpoint buffer. Latency is measured from the moment the
+// last byte of a frame has fully arrived on the wire (PPM: the edge closing
+// the last channel) to the report that carries it. One JSON object per
+// protocol and mapping is printed to stdout.
+//
+//   simlatency <firmware.elf> [--protocol <name>] [--mapping <name>] [--frames <n>] [--label <rev>]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "sim_avr.h"
+#include "sim_irq.h"
+#include "avr_uart.h"
+#include "avr_ioport.h"
+#include "avr_timer.h"
+
+#include "config.h"
+#include "bench.h"
+#include "bench_sim.h"
+#include "bench_streams.h"
+
+struct Run {
+  bool ready = false;
+  std::deque<avr_cycle_count_t> pending;  // Frames on the wire not yet reported
+  std::vector<uint32_t> latency;          // Cycles, one per reported frame
+  uint32_t reports = 0;
+  uint32_t coalesced = 0;                 // Frames overtaken by a newer one before a report
+  avr_cycle_count_t ledStart = 0;
+  uint32_t ledShows = 0;
+  uint64_t ledCycles = 0;
+  uint32_t ledMax = 0;
+};
+
+static void onMarker(avr_t *avr, avr_io_addr_t addr, uint8_t v, void *param) {
+  Run *run = (Run *)param;
+  avr_cycle_count_t now = avr->cycle;
+
+  switch (v) {
+    case BENCH_READY:
+      run->ready = true;
+      break;
+    case BENCH_HID_SENT: {
+      run->reports++;
+      // The report carries the newest frame that has fully arrived
+      int newest = -1;
+      for (size_t i = 0; i < run->pending.size() && run->pending[i] <= now; i++) {
+        newest = i;
+      }
+      if (newest < 0) break;
+      run->latency.push_back(now - run->pending[newest]);
+      run->coalesced += newest;
+      run->pending.erase(run->pending.begin(), run->pending.begin() + newest + 1);
+      break;
+    }
+    case BENCH_LED_START:
+      run->ledStart = now;
+      break;
+    case BENCH_LED_END: {
+      uint32_t cycles = now - run->ledStart;
+      run->ledShows++;
+      run->ledCycles += cycles;
+      if (cycles > run->ledMax) run->ledMax = cycles;
+      break;
+    }
+  }
+}
+
+static double cyclesToUs(avr_t *avr, uint64_t cycles) {
+  return cycles * 1000000.0 / avr->frequency;
+}
+
+static bool benchLatency(const char *elf, const BenchProtocol &protocol, const BenchMapping &mapping,
+                         int frames, const char *label) {
+  JoystickConfig cfg;
+  mapping.apply(&cfg);
+  cfg.protocol = protocol.id;
+  avr_t *avr = loadFirmware(elf, cfg);
+  if (!avr) return false;
+
+  Run run;
+  avr_register_io_write(avr, BENCH_MARK_IO_ADDR, onMarker, &run);
+
+  // Boot until the joystick loop is about to start
+  while (!run.ready) {
+    if (!runUntil(avr, avr->cycle + 1000)) return false;
+    if (avr->cycle > avr->frequency) {
+      fprintf(stderr, "simlatency: %s never reached BENCH_READY\n", protocol.name);
+      return false;
+    }
+  }
+
+  std::vector<BenchEvent> events;
+  buildStream(protocol, frames, &events);
+
+  avr_irq_t *uartIn = avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('1'), UART_IRQ_INPUT);
+  avr_irq_t *ppmPin = ppmInput(avr, protocol);
+
+  // A byte has arrived once its stop bit is on the wire, an edge at once
+  uint64_t arrivalNs = isPPM(protocol) ? 0 : protocol.byteTimeNs;
+
+  avr_cycle_count_t start = avr->cycle;
+  for (const BenchEvent &event : events) {
+    if (!runUntil(avr, start + nsToCycles(avr, event.timeNs))) return false;
+    if (event.kind == BENCH_EVENT_BYTE) avr_raise_irq(uartIn, event.value);
+    else avr_raise_irq(ppmPin, event.value);
+    if (event.frameEnd) run.pending.push_back(start + nsToCycles(avr, event.timeNs + arrivalNs));
+  }
+  // Let the last frame drain (PPM only closes a frame on the next sync gap)
+  runUntil(avr, avr->cycle + nsToCycles(avr, 50000000));
+  avr_cycle_count_t elapsed = avr->cycle - start;
+
+  std::vector<uint32_t> &lat = run.latency;
+  std::sort(lat.begin(), lat.end());
+  size_t n = lat.size();
+
+  printf("{\"label\": \"%s\", \"protocol\": \"%s\", \"mapping\": \"%s\", \"f_cpu\": %lu, \"frames_sent\": %d",
+         label, protocol.name, mapping.name, (unsigned long)avr->frequency, frames);
+  printf(", \"frames_reported\": %u, \"frames_coalesced\": %u, \"frames_lost\": %u, \"reports\": %u",
+         (unsigned)n, run.coalesced, (unsigned)run.pending.size(), run.reports);
+  if (n) {
+    printf(", \"latency_us\": {\"min\": %.1f, \"median\": %.1f, \"p99\": %.1f, \"max\": %.1f}",
+           cyclesToUs(avr, lat[0]), cyclesToUs(avr, lat[n / 2]),
+           cyclesToUs(avr, lat[std::min(n - 1, n * 99 / 100)]), cyclesToUs(avr, lat[n - 1]));
+  } else {
+    printf(", \"latency_us\": null");
+  }
+  printf(", \"led\": {\"shows\": %u, \"mean_us\": %.1f, \"max_us\": %.1f, \"cpu_pct\": %.1f}}\n",
+         run.ledShows, run.ledShows ? cyclesToUs(avr, run.ledCycles) / run.ledShows : 0.0,
+         cyclesToUs(avr, run.ledMax), elapsed ? 100.0 * run.ledCycles / elapsed : 0.0);
+
+  avr_terminate(avr);
+  return true;
+}
+
+int main(int argc, char **argv) {
+  const char *elf = nullptr;
+  const char *onlyProtocol = nullptr;
+  const char *onlyMapping = nullptr;
+  const char *label = "";
+  int frames = 500;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--protocol") && i + 1 < argc) onlyProtocol = argv[++i];
+    else if (!strcmp(argv[i], "--mapping") && i + 1 < argc) onlyMapping = argv[++i];
+    else if (!strcmp(argv[i], "--frames") && i + 1 < argc) frames = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--label") && i + 1 < argc) label = argv[++i];
+    else elf = argv[i];
+  }
+  if (!elf) {
+    fprintf(stderr, "usage: %s <firmware.elf> [--protocol <name>] [--mapping <name>] [--frames <n>] [--label <rev>]\n", argv[0]);
+    return 2;
+  }
+
+  bool ok = true;
+  for (const BenchProtocol *p = benchProtocols; p->name; p++) {
+    if (onlyProtocol && strcmp(onlyProtocol, p->name)) continue;
+    for (const BenchMapping *m = benchMappings; m->name; m++) {
+      if (onlyMapping && strcmp(onlyMapping, m->name)) continue;
+      ok &= benchLatency(elf, *p, *m, frames, label);
+    }
+  }
+  return ok ? 0 : 1;
+}
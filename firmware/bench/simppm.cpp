@@ -0,0 +1,184 @@
+// PPM accuracy check
+//
+// Loads the [env:bench] firmware once for each PPM engine (ppm on pin 0,
+// ppm_icp on the Timer1 input capture) and plays a PPM train whose channel
+// pulses have known widths on a 0.5us grid. The channels the firmware decodes
+// come back through the BENCH_CHANNEL markers and are compared against the
+// widths that were sent. One JSON object per engine is printed to stdout.
+//
+// ppm_icp must reproduce every width rounded to the nearest us, otherwise the
+// exit status is 1. The pin 0 engine is only measured.
+//
+//   simppm <firmware.elf> [--protocol <name>] [--frames <n>] [--label <rev>]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <deque>
+#include <vector>
+
+#include "sim_avr.h"
+#include "sim_irq.h"
+
+#include "config.h"
+#include "bench.h"
+#include "bench_sim.h"
+#include "bench_streams.h"
+
+#define PPM_CHANNELS 8
+#define PPM_HIGH_NS 300000 // High part of every pulse, the rest of the slot is low
+
+struct SentFrame {
+  avr_cycle_count_t closed;          // First edge of the next frame, ends the sync gap
+  double widthUs[PPM_CHANNELS];
+};
+
+struct Run {
+  bool ready = false;
+  std::deque<SentFrame> pending;     // Frames closed on the wire, not decoded yet
+  uint16_t decoded[16];
+  uint8_t channel = 16;              // Next BENCH_CHANNEL slot, 16 = not in a frame
+  uint32_t frames = 0;
+  uint32_t exact = 0;                // Frames where every channel is the width rounded to 1us
+  double errorMin = 0;
+  double errorMax = 0;
+  double errorAbsTotal = 0;
+  double offsetMin[PPM_CHANNELS];    // Per channel spread of decoded - sent, the jitter
+  double offsetMax[PPM_CHANNELS];
+};
+
+static void finishFrame(avr_t *avr, Run *run) {
+  // The frame the decoder just closed is the newest one whose sync gap ended
+  int newest = -1;
+  for (size_t i = 0; i < run->pending.size() && run->pending[i].closed <= avr->cycle; i++) {
+    newest = i;
+  }
+  if (newest < 0) return;
+  const SentFrame sent = run->pending[newest];
+  run->pending.erase(run->pending.begin(), run->pending.begin() + newest + 1);
+
+  bool exact = true;
+  for (int i = 0; i < PPM_CHANNELS; i++) {
+    double error = run->decoded[i] - sent.widthUs[i];
+    if (run->frames == 0 || error < run->errorMin) run->errorMin = error;
+    if (run->frames == 0 || error > run->errorMax) run->errorMax = error;
+    if (run->frames == 0 || error < run->offsetMin[i]) run->offsetMin[i] = error;
+    if (run->frames == 0 || error > run->offsetMax[i]) run->offsetMax[i] = error;
+    run->errorAbsTotal += fabs(error);
+    if (run->decoded[i] != (uint16_t)floor(sent.widthUs[i] + 0.5)) exact = false;
+  }
+  run->frames++;
+  if (exact) run->exact++;
+}
+
+static void onMarker(avr_t *avr, avr_io_addr_t addr, uint8_t v, void *param) {
+  Run *run = (Run *)param;
+
+  switch (v) {
+    case BENCH_READY:
+      run->ready = true;
+      break;
+    case BENCH_MAP_END:
+      run->channel = 0;
+      break;
+    case BENCH_CHANNEL:
+      if (run->channel >= 16) break;
+      run->decoded[run->channel++] = avr->data[BENCH_DATA_LO_IO_ADDR] | (avr->data[BENCH_DATA_HI_IO_ADDR] << 8);
+      if (run->channel == 16) finishFrame(avr, run);
+      break;
+  }
+}
+
+// Pulse widths from 1000 to 2000us in 0.5us steps, different for every channel and frame
+static double pulseWidthUs(int frame, int channel) {
+  return 1000.0 + ((frame * 37 + channel * 113) % 2001) * 0.5;
+}
+
+static bool checkPPM(const char *elf, const BenchProtocol &protocol, int frames, const char *label, bool *passed) {
+  JoystickConfig cfg;
+  benchConfig(&cfg, protocol.id);
+  avr_t *avr = loadFirmware(elf, cfg);
+  if (!avr) return false;
+
+  Run run;
+  avr_register_io_write(avr, BENCH_MARK_IO_ADDR, onMarker, &run);
+
+  while (!run.ready) {
+    if (!runUntil(avr, avr->cycle + 1000)) return false;
+    if (avr->cycle > avr->frequency) {
+      fprintf(stderr, "simppm: %s never reached BENCH_READY\n", protocol.name);
+      return false;
+    }
+  }
+
+  avr_irq_t *pin = ppmInput(avr, protocol);
+  avr_cycle_count_t start = avr->cycle;
+  std::vector<SentFrame> sent(frames);
+
+  // One more rising edge after the last frame closes it
+  for (int f = 0; f <= frames; f++) {
+    uint64_t t = (uint64_t)f * protocol.framePeriodUs * 1000;
+    if (f > 0) {
+      sent[f - 1].closed = start + nsToCycles(avr, t);
+      run.pending.push_back(sent[f - 1]);
+    }
+    int edges = (f < frames) ? PPM_CHANNELS + 1 : 1;
+    for (int i = 0; i < edges; i++) {
+      if (!runUntil(avr, start + nsToCycles(avr, t))) return false;
+      avr_raise_irq(pin, 1);
+      if (!runUntil(avr, start + nsToCycles(avr, t + PPM_HIGH_NS))) return false;
+      avr_raise_irq(pin, 0);
+      if (i < PPM_CHANNELS && f < frames) {
+        sent[f].widthUs[i] = pulseWidthUs(f, i);
+        t += (uint64_t)(sent[f].widthUs[i] * 1000);
+      }
+    }
+  }
+  runUntil(avr, avr->cycle + nsToCycles(avr, 5000000));
+
+  double jitter = 0;
+  for (int i = 0; i < PPM_CHANNELS && run.frames; i++) {
+    if (run.offsetMax[i] - run.offsetMin[i] > jitter) jitter = run.offsetMax[i] - run.offsetMin[i];
+  }
+
+  printf("{\"label\": \"%s\", \"protocol\": \"%s\", \"f_cpu\": %lu, \"frames_sent\": %d, \"frames_decoded\": %u, \"frames_exact\": %u",
+         label, protocol.name, (unsigned long)avr->frequency, frames, run.frames, run.exact);
+  printf(", \"error_us\": {\"min\": %.1f, \"max\": %.1f, \"mean_abs\": %.2f}, \"jitter_us\": %.1f}\n",
+         run.errorMin, run.errorMax, run.frames ? run.errorAbsTotal / (run.frames * PPM_CHANNELS) : 0.0, jitter);
+
+  // The capture engine skips the frame it powers up in, every other one must be exact
+  if (protocol.id == PPM_CAPTURE) {
+    *passed = run.frames + 1 >= (uint32_t)frames && run.exact == run.frames;
+  }
+
+  avr_terminate(avr);
+  return true;
+}
+
+int main(int argc, char **argv) {
+  const char *elf = nullptr;
+  const char *only = nullptr;
+  const char *label = "";
+  int frames = 200;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--protocol") && i + 1 < argc) only = argv[++i];
+    else if (!strcmp(argv[i], "--frames") && i + 1 < argc) frames = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--label") && i + 1 < argc) label = argv[++i];
+    else elf = argv[i];
+  }
+  if (!elf) {
+    fprintf(stderr, "usage: %s <firmware.elf> [--protocol <name>] [--frames <n>] [--label <rev>]\n", argv[0]);
+    return 2;
+  }
+
+  bool ok = true;
+  bool passed = true;
+  for (const BenchProtocol *p = benchProtocols; p->name; p++) {
+    if (!isPPM(*p)) continue;
+    if (only && strcmp(only, p->name)) continue;
+    ok &= checkPPM(elf, *p, frames, label, &passed);
+  }
+  return (ok && passed) ? 0 : 1;
+}
@@ -0,0 +1,41 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+/*
+Benchmark markers shared by the [env:bench] firmware (src/hal_bench.cpp) and
+the simavr harnesses in bench/.
+
+The firmware writes a marker code to GPIOR0 around each stage it wants timed.
+The harness hooks writes to that register and timestamps them with the
+simulated cycle counter. A marker write is a single OUT instruction (1 cycle,
+plus 1 for loading the code), which is included in every reported number.
+
+After BENCH_MAP_END the firmware also hands out the 16 decoded channels, one
+BENCH_CHANNEL marker each, outside every timed stage.
+*/
+
+#define BENCH_MARK_IO_ADDR 0x3E // GPIOR0 in data space on the ATmega32U4
+
+#define BENCH_READY        0x01 // Decoder initialized, harness may start the stream
+#define BENCH_DECODE_START 0x10 // Entering readXxx()
+#define BENCH_DECODE_END   0x11 // readXxx() returned without a frame
+#define BENCH_FRAME_END    0x12 // readXxx() returned a complete frame
+#define BENCH_MAP_START    0x20 // Entering updateJoystickFromChannels()
+#define BENCH_MAP_END      0x21
+#define BENCH_ISR_START    0x30 // Entering the PPM edge handler
+#define BENCH_ISR_END      0x31
+#define BENCH_LED_START    0x40 // Entering halLedShow()
+#define BENCH_LED_END      0x41
+#define BENCH_HID_SENT     0x50 // Last report byte written to the HID endpoint
+#define BENCH_CHANNEL      0x60 // Next channelData value of the frame is in GPIOR2:GPIOR1
+#define BENCH_PROTOCOL     0x70 // rcInputProtocol() changed, the new value is in GPIOR1
+
+#define BENCH_DATA_LO_IO_ADDR 0x4A // GPIOR1
+#define BENCH_DATA_HI_IO_ADDR 0x4B // GPIOR2
+
+#ifdef __AVR__
+#include <avr/io.h>
+#define BENCH_MARK(code) (GPIOR0 = (code))
+#endif
+
+#endif // BENCH_H
@@ -0,0 +1,26 @@
+#ifndef BOOT_TIMING_H
+#define BOOT_TIMING_H
+
+#include <stdint.h>
+
+// Boot phases in the order joystick mode reaches them. Each one is stamped
+// with halMicros() the first time it is reached, 'boot' prints them.
+enum BootPhase {
+  BOOT_SETUP = 0,           // setup() entered, USB is already attached by the core
+  BOOT_CONFIG_LOADED,       // EEPROM record loaded
+  BOOT_HID_CREATED,         // HID descriptor registered
+  BOOT_INPUT_STARTED,       // Decoder running
+  BOOT_USB_CONFIGURED,      // Host finished enumeration, reports can go out
+  BOOT_FIRST_FRAME,         // First RC frame decoded
+  BOOT_FIRST_REPORT,        // First HID report sent
+  BOOT_PHASE_COUNT
+};
+
+void markBootPhase(uint8_t phase);
+bool bootPhaseReached(uint8_t phase);
+uint32_t bootPhaseMicros(uint8_t phase);
+
+// Lower case name of the phase, in flash
+const char *bootPhaseName(uint8_t phase);
+
+#endif // BOOT_TIMING_H
@@ -0,0 +1,42 @@
+#ifndef CHANNEL_CONDITIONING_H
+#define CHANNEL_CONDITIONING_H
+
+#include <stdint.h>
+
+// Channels with an expo share one curve table per distinct expo value
+#define CONDITIONING_CURVES_MAX 4
+
+// Precompute the conditioning for every channel whose settings.calibration
+// differs from the default
+void beginChannelConditioning();
+
+// Condition channelData in place, once per decoded frame
+void conditionChannels();
+
+// Number of curve tables settings.calibration needs
+uint8_t conditioningCurvesNeeded();
+
+// --- Calibration capture ---
+#define CAL_MIN_TRAVEL 200      // us a channel has to move to be calibrated
+
+struct CalibrationCapture {
+  uint16_t min[16];
+  uint16_t max[16];
+  uint16_t center[16];          // Recent average, 2 fraction bits
+  uint16_t frames;
+};
+
+extern CalibrationCapture calibrationCapture;
+
+// Forget everything captured so far
+void startCalibrationCapture();
+
+// Track one frame of unconditioned channelData
+void captureCalibrationFrame();
+
+// Write the captured endpoints and centre into settings.calibration for every
+// channel that moved at least CAL_MIN_TRAVEL. Deadband, expo and reverse are
+// kept. Returns a bit per channel that was written.
+uint16_t finishCalibrationCapture();
+
+#endif // CHANNEL_CONDITIONING_H
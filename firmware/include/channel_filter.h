@@ -0,0 +1,13 @@
+#ifndef CHANNEL_FILTER_H
+#define CHANNEL_FILTER_H
+
+#include <stdint.h>
+
+// Set up the filter for every channel with settings.filterCutoff > 0 and
+// forget all previous state
+void beginChannelFilter();
+
+// Filter channelData in place, once per decoded frame
+void filterChannels();
+
+#endif // CHANNEL_FILTER_H
@@ -0,0 +1,162 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stdint.h>
+
+// #define DEBUG  // Enable debug serial output
+// #define PROFILE  // Loop profiler and the 'stats' command (see profiler.h)
+
+/*
+EEPROM record store
+
+The configuration is saved as one record: a StoreHeader, then JoystickConfig,
+then DeviceSettings, little endian as the AVR lays them out. Each save goes to
+the next of STORE_SLOTS fixed slots with the sequence number one higher, so
+the cells wear evenly and an interrupted write leaves the previous record
+intact. At boot every slot is checked (magic, version, length, CRC16) and the
+valid one with the newest sequence is loaded.
+
+A record shorter than the current structs loads what it has, the rest keeps
+its defaults, so fields can be appended to DeviceSettings without a version
+bump. STORE_VERSION only changes when existing fields move or change meaning.
+*/
+#define STORE_SLOTS      3
+#define STORE_SLOT_SIZE  340              // 3 slots fill the 1 KB EEPROM
+#define STORE_MAGIC      0xC0F6
+#define STORE_VERSION    1
+
+struct StoreHeader {
+  uint16_t magic;         // STORE_MAGIC
+  uint8_t version;        // STORE_VERSION
+  uint8_t reserved;
+  uint16_t sequence;      // +1 per save, wraps
+  uint16_t length;        // Bytes after the header
+  uint16_t crc;           // crc16Update() from 0xFFFF over the header up to here, then the payload
+};
+
+// CRC-16/CCITT-FALSE (poly 0x1021), shared with the bench harness
+inline uint16_t crc16Update(uint16_t crc, uint8_t byte) {
+  crc ^= (uint16_t)byte << 8;
+  for (uint8_t i = 0; i < 8; i++) {
+    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+// Layout written by firmware before the record store. Only read, to migrate
+// a dongle on its first boot with this firmware.
+#define EEPROM_SIGNATURE_ADDR    0
+#define EEPROM_CONFIG_START_ADDR 8
+#define EEPROM_SIGNATURE         0x12345678
+
+#define IBUS 1
+#define SBUS 2
+#define CRSF 3
+#define DSMX 4
+#define DSM2 5
+#define FPORT 6
+#define PPM  7
+#define PPM_CAPTURE 8 // PPM on pin 4, timed by the Timer1 input capture unit
+#define AUTO 9        // Detect the protocol from the incoming signal (see rc_input.cpp)
+
+// Configuration structure
+struct JoystickConfig {
+  uint8_t protocol;       // Protocol type (e.g., IBusBM)
+  uint8_t x_axis;         // Channel for X axis (1-16, 0=disabled)
+  uint8_t y_axis;         // Channel for Y axis
+  uint8_t z_axis;         // Channel for Z axis
+  uint8_t rx_axis;        // Channel for Rx axis (X rotation)
+  uint8_t ry_axis;        // Channel for Ry axis (Y rotation)
+  uint8_t rz_axis;        // Channel for Rz axis (Z rotation)
+  uint8_t rudder;         // Channel for rudder (if applicable)
+  uint8_t throttle;       // Channel for throttle (if applicable)
+  uint8_t accelerator;    // Channel for accelerator (if applicable)
+  uint8_t brake;          // Channel for brake (if applicable)
+  uint8_t steering;       // Channel for steering (if applicable)
+  uint8_t buttons[32];    // Channels for 32 buttons
+  uint8_t hat_switch1;    // Channel for hat switch 1
+  uint8_t hat_switch2;    // Channel for hat switch 2
+};
+
+// Binary image of JoystickConfig for the 'get'/'put' commands, sent as a
+// SERIAL_FRAME_CONFIG frame (see serial_frame.h):
+//   0   SERIAL_FRAME_CONFIG
+//   1   CONFIG_IMAGE_VERSION, bumped whenever JoystickConfig changes
+//   2   sizeof(JoystickConfig)
+//   3-  JoystickConfig, field by field as declared above
+#define CONFIG_IMAGE_VERSION 1
+#define CONFIG_IMAGE_SIZE (3 + sizeof(JoystickConfig))
+
+// In the old layout the settings followed JoystickConfig with their own
+// signature and size
+#define EEPROM_SETTINGS_ADDR      (EEPROM_CONFIG_START_ADDR + sizeof(JoystickConfig))
+#define EEPROM_SETTINGS_SIGNATURE 0x5E77
+
+#define DEFAULT_REPORT_MIN_INTERVAL 0   // ms, send every change right away
+#define DEFAULT_REPORT_KEEPALIVE    250 // ms
+#define DEFAULT_FILTER_CUTOFF       0   // Channel filter off
+#define DEFAULT_FILTER_BETA         128
+#define DEFAULT_FAILSAFE_TIMEOUT    100 // ms
+
+// Failsafe actions of hats and buttons. Axes hold at 0, any other value is
+// the channel value (1000-2000) the axis goes to.
+#define FAILSAFE_HOLD    0              // Keep the last value
+#define FAILSAFE_RELEASE 1              // Hat centred, button released
+#define FAILSAFE_PRESS   2              // Buttons only
+#define FAILSAFE_AXES    11             // One per HidAxis (hal.h)
+
+// Channel calibration limits, in us
+#define CAL_LIMIT_MIN   800
+#define CAL_LIMIT_MAX   2200
+#define CAL_MIN_SPAN    50   // Smallest distance from centre (plus deadband) to either endpoint
+
+// Per-channel conditioning, applied before the channel is mapped to a control
+struct ChannelCalibration {
+  uint16_t min;                 // Endpoint that maps to 1000
+  uint16_t center;              // Maps to 1500
+  uint16_t max;                 // Maps to 2000
+  uint8_t deadband;             // us either side of centre that read as centre
+  uint8_t expo;                 // 0-100 %, softens the centre
+  uint8_t reverse;              // 1 = swap the endpoints
+};
+
+struct DeviceSettings {
+  uint16_t signature;           // EEPROM_SETTINGS_SIGNATURE
+  uint8_t size;                 // sizeof(DeviceSettings)
+  uint16_t reportMinInterval;   // Minimum ms between HID reports, 0 = no limit
+  uint16_t reportKeepAlive;     // Resend an unchanged report after this many ms, 0 = never
+  uint8_t filterCutoff[16];     // Per channel smoothing at rest (1 = heaviest, 255 = lightest), 0 = off
+  uint8_t filterBeta[16];       // Per channel: how fast the filter opens up as the stick moves
+  ChannelCalibration calibration[16];
+
+  // What the joystick reports once the signal is lost, see joystick_output.cpp
+  uint16_t failsafeTimeout;     // ms without a valid frame, 0 = failsafe off
+  uint16_t failsafeAxes[FAILSAFE_AXES]; // 0 = hold, otherwise the channel value to go to
+  uint8_t failsafeHats[2];      // FAILSAFE_HOLD or FAILSAFE_RELEASE
+  uint8_t failsafeLostButton;   // Button 1-32 held down while the signal is lost, 0 = none
+  uint8_t failsafeButtons[8];   // Two bits per button, button 1 in the low bits: FAILSAFE_HOLD, _RELEASE or _PRESS
+};
+
+static_assert(sizeof(StoreHeader) + sizeof(JoystickConfig) + sizeof(DeviceSettings) <= STORE_SLOT_SIZE,
+              "Configuration no longer fits a store slot");
+static_assert(sizeof(DeviceSettings) <= 255, "DeviceSettings.size is one byte");
+
+extern JoystickConfig config;
+extern DeviceSettings settings;
+
+// Newest valid record, or the old layout (which is then saved as a record).
+// False if neither is there.
+bool loadConfigFromEEPROM();
+// Write a record to the next slot and read it back, false if it does not verify
+bool saveConfigToEEPROM();
+void generateDefaultConfig();
+// Unmaps every axis, hat and button. Calibration, filter, failsafe and the
+// other DeviceSettings are left as they are.
+void generateClearConfig();
+void generateDefaultSettings();
+void generateDefaultCalibration(ChannelCalibration *cal);
+bool isDefaultCalibration(const ChannelCalibration &cal);
+uint8_t packConfigImage(uint8_t *payload);
+bool unpackConfigImage(const uint8_t *payload, uint8_t length);
+
+#endif // CONFIG_H
@@ -0,0 +1,100 @@
+#ifndef CONFIG_FIELDS_H
+#define CONFIG_FIELDS_H
+
+#include <stdint.h>
+
+/*
+Settable configuration fields
+
+Every value the 'set' command changes is one entry of a PROGMEM table, in
+the order 'config' prints them. An entry points at a byte or word in
+JoystickConfig or DeviceSettings and holds its range. Per-channel fields
+(button_1..32, filter_1..16, ...) are one entry with a count and the
+distance between copies. 'set', 'config' and 'help' all work from the table,
+so a new field only needs a new line in config_fields.cpp.
+
+Names are found by a 16 bit hash stored with every entry, a hit is
+confirmed with one compare against the name in flash.
+*/
+
+#define FIELD_NAME_MAX 17               // "report_keepalive" and the terminator
+
+// ConfigField.flags
+#define FIELD_SETTINGS    0x01          // In DeviceSettings, otherwise in JoystickConfig
+#define FIELD_WORD        0x02          // uint16_t, otherwise uint8_t
+#define FIELD_PROTOCOL    0x04          // Set by protocol name, see findProtocol()
+#define FIELD_CALIBRATION 0x08          // Checked against the rest of its ChannelCalibration
+#define FIELD_2BIT        0x10          // Two bits per copy, four copies to a byte, stride unused
+#define FIELD_ZERO_OFF    0x20          // 0 is accepted too and turns the field off, min-max holds the rest
+
+// Sections, in print order. All entries of a section are next to each other
+// and share the same count.
+enum FieldSection {
+  SECTION_GENERAL = 0,
+  SECTION_AXES,
+  SECTION_HATS,
+  SECTION_BUTTONS,
+  SECTION_REPORTS,
+  SECTION_FILTERS,
+  SECTION_CALIBRATION,
+  SECTION_FAILSAFE,
+  SECTION_FAILSAFE_BUTTONS,
+  SECTION_COUNT
+};
+
+struct ConfigField {
+  char name[FIELD_NAME_MAX];            // Lower case, per-channel fields without the _<n>
+  uint16_t hash;                        // configFieldHash(name)
+  uint8_t section;
+  uint8_t flags;
+  uint8_t offset;                       // Of the first copy in its struct
+  uint8_t count;                        // 1, or the number of per-channel copies
+  uint8_t stride;                       // Bytes from one copy to the next
+  uint16_t min;
+  uint16_t max;
+  uint16_t idle;                        // Per-channel copies left at this value are not printed
+};
+
+// setConfigField() results
+#define FIELD_SET_OK     0
+#define FIELD_SET_SPAN   1              // Calibration would leave less than CAL_MIN_SPAN
+#define FIELD_SET_CURVES 2              // More than CONDITIONING_CURVES_MAX expo values
+
+// djb2 cut to 16 bits. constexpr so the table stores it, and the same
+// function hashes the name typed in.
+constexpr uint16_t configFieldHash(const char *name, uint16_t hash = 5381) {
+  return *name ? configFieldHash(name + 1, (uint16_t)(((uint32_t)hash << 5) + hash + (uint8_t)*name)) : hash;
+}
+
+extern const uint8_t configFieldCount;
+
+// Copy entry id out of flash
+void readConfigField(uint8_t id, ConfigField *field);
+
+// Look up "x_axis", "button_12", "cal_min_3", ... (lower case). Returns the
+// entry id, -1 if no entry has that name. *index is the 0 based copy for
+// per-channel fields, not checked against the count.
+int8_t findConfigField(const char *name, uint8_t *index);
+
+uint16_t getConfigField(const ConfigField &field, uint8_t index);
+
+// True if value is within [min, max], or 0 for a FIELD_ZERO_OFF field
+bool configFieldAccepts(const ConfigField &field, uint16_t value);
+
+// Store value, which must already pass configFieldAccepts(). Calibration
+// fields are checked against the rest of the channel and left unchanged if
+// the result would not work. Returns FIELD_SET_*.
+uint8_t setConfigField(const ConfigField &field, uint8_t index, uint16_t value);
+
+// Section heading and the note 'help' prints under it, both in flash.
+// SECTION_GENERAL has no heading.
+const char *configSectionTitle(uint8_t section);
+const char *configSectionNote(uint8_t section);
+
+// Lower case protocol names ("ibus" ... "auto") in flash, nullptr if unknown
+const char *protocolName(uint8_t protocol);
+
+// Protocol id for a lower case name, 0 if unknown
+uint8_t findProtocol(const char *name);
+
+#endif // CONFIG_FIELDS_H
@@ -0,0 +1,119 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+
+/*
+Hardware abstraction layer
+
+The decode and mapping core (config.cpp, rc_input.cpp, joystick_output.cpp,
+status_led.cpp) only reaches the hardware through the functions below.
+hal_avr.cpp implements them on the Pro Micro, hal_native.cpp implements them
+with stub drivers so the same core builds and runs on the host
+([env:native]), and hal_bench.cpp runs it bare-metal under simavr.
+*/
+
+// --- Flash constants ---
+// Lookup tables are declared PROGMEM and read with pgm_read_byte()/
+// pgm_read_word(). Off the AVR they are ordinary const arrays.
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#else
+#include <string.h>
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_ptr(addr) (*(const void * const *)(addr))
+#define memcpy_P memcpy
+#define strcmp_P strcmp
+#endif
+
+// --- Clock ---
+uint32_t halMillis();
+uint32_t halMicros();
+
+// --- Byte source (RC receiver UART) ---
+#define HAL_SERIAL_8N1 0
+#define HAL_SERIAL_8E2 1
+
+// handler runs in interrupt context once for every received byte. Bytes with
+// a parity error are dropped before they reach it.
+void halSerialBegin(uint32_t baud, uint8_t format, void (*handler)(uint8_t byte));
+
+// Bytes the UART lost since boot because the one before was not read in time
+uint32_t halSerialOverruns();
+
+// --- Edge source (PPM input) ---
+void halAttachPPM(void (*handler)());
+
+// --- Capture source (PPM on the Timer1 input capture pin) ---
+#define HAL_CAPTURE_TICKS_PER_US 2   // Timer1 at F_CPU/8 on the 16 MHz Pro Micro
+#define HAL_CAPTURE_OVERFLOW 0xFFFF  // Edge came more than one timer period after the previous one
+
+// handler runs in interrupt context for every rising edge on ICP1 (pin 4) with
+// the ticks since the previous edge. The timer latches the edge in hardware,
+// so interrupt latency does not show up in the interval.
+void halAttachPPMCapture(void (*handler)(uint16_t ticks));
+
+// Stop whichever of the three sources above is running, so another protocol
+// can be started without a reboot
+void halInputEnd();
+
+void halNoInterrupts();
+void halInterrupts();
+
+// --- Millisecond tick (failsafe watchdog) ---
+// handler runs in interrupt context about once per millisecond, off a
+// hardware timer, however long the loop is held up
+void halTickBegin(void (*handler)());
+
+// --- Cycle counter (loop profiler, see profiler.h) ---
+// Start the free running CPU cycle count. Only the profiler calls it, so the
+// timer it uses stays off otherwise.
+void halCyclesBegin();
+// CPU cycles since halCyclesBegin(), wraps after 2^32 (268s at 16 MHz)
+uint32_t halCycles();
+
+// --- Persistent store (EEPROM) ---
+void halStoreRead(uint16_t addr, void *data, uint16_t len);
+void halStoreWrite(uint16_t addr, const void *data, uint16_t len);
+
+// --- HID sink (USB joystick) ---
+// Axis ids follow the order of the axis fields in JoystickConfig
+enum HidAxis {
+  HID_AXIS_X = 0,
+  HID_AXIS_Y,
+  HID_AXIS_Z,
+  HID_AXIS_RX,
+  HID_AXIS_RY,
+  HID_AXIS_RZ,
+  HID_AXIS_RUDDER,
+  HID_AXIS_THROTTLE,
+  HID_AXIS_ACCELERATOR,
+  HID_AXIS_BRAKE,
+  HID_AXIS_STEERING,
+  HID_AXIS_COUNT
+};
+
+#define HID_AXIS_MAX 1023
+
+// axisMask has bit n set when HidAxis n is mapped
+bool halHidBegin(uint16_t axisMask, uint8_t buttonCount, uint8_t hatCount);
+void halHidSetAxis(uint8_t axis, uint16_t value);
+void halHidSetButtons(uint32_t buttons); // Bit n = button n + 1
+void halHidSetHat(uint8_t hat, int16_t value);
+void halHidSendState();
+// True once the host has configured the device. Reports sent before that are lost.
+bool halHidReady();
+
+// --- Status LED (single WS2812) ---
+void halLedBegin();
+void halLedShow(uint8_t r, uint8_t g, uint8_t b);
+
+// --- Debug output ---
+void halDebugPrint(const char *text);
+void halDebugPrint(int32_t value);
+void halDebugPrintln(const char *text = "");
+void halDebugPrintln(int32_t value);
+
+#endif // HAL_H
@@ -0,0 +1,41 @@
+#ifndef HAL_NATIVE_H
+#define HAL_NATIVE_H
+
+#include <stdint.h>
+
+/*
+Host side of the stub HAL (hal_native.cpp, [env:native] only)
+
+The capture replay and the unit tests under test/ play the part of the
+hardware through these: they move the clock, raise the interrupts the core
+attached through hal.h, and look at what the drivers were handed.
+*/
+
+#define NATIVE_STORE_SIZE 1024   // ATmega32U4 EEPROM size
+
+// --- Clock ---
+void nativeSetMicros(uint32_t micros);
+void nativeAdvanceMicros(uint32_t micros);
+
+// --- Interrupts ---
+// Each runs the handler attached through hal.h, nothing if none is
+void nativeSerialByte(uint8_t byte);     // USART1 receive
+void nativePPMEdge();                     // Pin 0 rising edge, timed with halMicros()
+void nativeCaptureEdge(uint32_t ticks);   // Timer1 capture, clamped to HAL_CAPTURE_OVERFLOW
+void nativeTick();                        // Millisecond tick
+
+// --- Byte source ---
+bool nativeSerialRunning();
+uint32_t nativeSerialBaud();
+uint8_t nativeSerialFormat();
+uint32_t nativeSerialByteMicros();       // Time on the wire per byte at that baud rate
+
+// --- Persistent store ---
+uint8_t *nativeStore();                  // NATIVE_STORE_SIZE bytes
+uint32_t nativeStoreWrites(uint16_t addr); // Writes to one cell since the last erase
+void nativeStoreErase();                 // All 0xFF, write counts back to 0
+
+// --- Status LED ---
+uint32_t nativeLedShows();               // halLedShow() calls since boot
+
+#endif // HAL_NATIVE_H
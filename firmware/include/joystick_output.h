@@ -0,0 +1,28 @@
+#ifndef JOYSTICK_OUTPUT_H
+#define JOYSTICK_OUTPUT_H
+
+#include <stdint.h>
+
+// HID report counters since boot. A frame counts towards unchanged, or
+// towards replaced once the next frame overtakes it, never both.
+struct ReportStats {
+  uint32_t sent;        // Reports sent for a changed state
+  uint32_t replaced;    // Changed frames held back by the minimum interval and overtaken by a newer one
+  uint32_t unchanged;   // Frames that gave the same report as the last one sent
+  uint32_t keepAlive;   // Unchanged reports repeated by the keep-alive
+};
+
+bool beginJoystick();
+void compileMapping();
+void joystickModeLoop();
+void updateJoystickFromChannels();
+void serviceHidReport();
+// Apply the failsafe actions when the watchdog reports the signal lost
+void serviceFailsafe();
+bool failsafeActive();
+ReportStats getReportStats();
+uint16_t mapChannelToAxis(uint16_t channelValue);
+bool mapChannelToButton(uint16_t channelValue);
+int mapChannelToHat(uint16_t channelValue);
+
+#endif // JOYSTICK_OUTPUT_H
@@ -0,0 +1,28 @@
+#ifndef MONITOR_H
+#define MONITOR_H
+
+#include <stdint.h>
+#include "serial_frame.h"
+
+/*
+Live channel monitor stream
+
+Config mode sends one SERIAL_FRAME_MONITOR frame (see serial_frame.h) per
+decoded RC frame while 'monitor' is running. Decoded, a frame is:
+
+  0      SERIAL_FRAME_MONITOR
+  1      sequence, +1 per frame built (a gap means frames were not sent)
+  2-3    link frames, low 16 bits of rcLink.frames (little endian)
+  4-5    link errors, low 16 bits of rcLink.errors
+  6-37   channelData[0..15] as sent to the mapping, in us
+  38     CRC8
+*/
+
+#define MONITOR_PAYLOAD_SIZE 39
+#define MONITOR_FRAME_MAX (MONITOR_PAYLOAD_SIZE + SERIAL_FRAME_OVERHEAD)
+
+// Build the frame for the current channelData into out, returns its length
+// including the trailing 0x00
+uint8_t buildMonitorFrame(uint8_t *out);
+
+#endif // MONITOR_H
@@ -0,0 +1,78 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include "config.h"
+#include "hal.h"
+
+/*
+Loop profiler
+
+Only built with PROFILE defined (config.h). The stages of the joystick loop
+are bracketed with PROFILE_START()/PROFILE_END(), which read the halCycles()
+counter and keep the count, min, max and mean cycles of every stage.
+profileLoop() at the top of loop() also sorts each loop period into a
+histogram with power of two buckets. 'stats' prints everything and starts
+over. Without PROFILE the brackets are empty and nothing is linked in.
+
+A bracket costs two halCycles() reads and a profileRecord() call, which
+profileBegin() measures once at boot together with profileLoop(). A stage
+reads at least the floor: the cycles an empty bracket reports. 'stats'
+adds them up to what the profiler costs one pass of the loop, from the
+number of brackets the passes it recorded actually ran.
+*/
+
+enum ProfileStage {
+  PROFILE_LOOP = 0,     // One pass of loop(), start to start
+  PROFILE_POLL,         // readProtocol() without a new frame
+  PROFILE_DECODE,       // readProtocol() that unpacked a frame, filter and conditioning included
+  PROFILE_MAP,          // updateJoystickFromChannels() up to the report
+  PROFILE_SEND,         // halHidSendState()
+  PROFILE_LED,          // updateLED()
+  PROFILE_STAGE_COUNT
+};
+
+#define PROFILE_BUCKETS      12
+#define PROFILE_BUCKET_SHIFT 8  // First bucket is under 256 cycles (16us), each next one twice as wide
+
+struct ProfileStats {
+  uint32_t count;
+  uint32_t min;                 // Cycles
+  uint32_t max;
+  uint32_t mean;
+};
+
+#ifdef PROFILE
+
+#define PROFILE_START(start) uint32_t start = halCycles()
+#define PROFILE_END(start, stage) profileRecord(stage, halCycles() - start)
+
+// Start the cycle counter and measure the bracket overhead
+void profileBegin();
+// Once at the top of loop()
+void profileLoop();
+void profileRecord(uint8_t stage, uint32_t cycles);
+
+// What was recorded since boot or the last profileReset(). count is 0 if the
+// stage did not run.
+void readProfileStats(uint8_t stage, ProfileStats *stats);
+uint32_t profileBucket(uint8_t bucket);
+void profileReset();
+
+// Cycles a bracket adds to the loop, and the cycles an empty one reports
+uint16_t profileOverhead();
+uint16_t profileFloor();
+// Cycles profileLoop() adds to every pass, at its shortest
+uint16_t profileLoopOverhead();
+
+// Lower case name of the stage, in flash
+const char *profileStageName(uint8_t stage);
+
+#else
+
+#define PROFILE_START(start)
+#define PROFILE_END(start, stage)
+
+#endif // PROFILE
+
+#endif // PROFILER_H
@@ -0,0 +1,175 @@
+#ifndef RC_DECODER_H
+#define RC_DECODER_H
+
+#include <stdint.h>
+#include "config.h"
+#include "hal.h"
+
+/*
+Decoder interface
+
+Each protocol is one class with static members. UART protocols plug into
+UartDecoder<>, which owns everything they have in common: starting the UART,
+the byte timeout, the double buffered frame hand-off and the link counters.
+The template is expanded once per protocol, so the receive interrupt and the
+unpacking call straight into the protocol's code with no switch or virtual
+call in between. beginRcInput() binds the configured protocol's begin()/read()
+pair once at boot.
+
+A UART protocol class provides:
+
+  BAUD, FORMAT           Passed to halSerialBegin()
+  BYTE_TIMEOUT_MS        Gap after which a partial frame is dropped
+  FRAME_MAX              Largest frame it publishes
+  receive(rx, byte)      Interrupt context. Stores the byte into rx and returns
+                         one of the RX_* results below, which also keep the
+                         link counters
+  unpack(frame)          Loop context. Writes channelData from a published
+                         frame, returns false if the frame must not be reported
+
+The UART is quiet whenever no partial frame is being assembled.
+
+Protocols that are not byte streams (PPM) implement begin()/read()/quiet()
+themselves.
+*/
+
+struct RcDecoder {
+  uint8_t protocol;   // Protocol id from config.h
+  void (*begin)();    // Start the receiver input, called once at boot
+  bool (*read)();     // True when a new frame was unpacked into channelData
+  bool (*quiet)();    // True between frames, when a short interrupt lockout cannot hurt
+};
+
+#define RX_FRAME_MAX 64 // Largest CRSF frame
+
+// receive() results
+#define RX_MORE  0 // Frame not complete yet
+#define RX_FRAME 1 // Frame complete and valid, publish it
+#define RX_BAD   2 // Frame complete but failed its check
+#define RX_DROP  3 // Bytes that do not make a frame, start over. Counted as a resync when a frame had started.
+#define RX_SKIP  4 // Complete frame of a type we do not use, start over
+
+// Frame assembly state of the active UART decoder
+struct RxFrames {
+  uint8_t buffer[2][RX_FRAME_MAX];
+  uint8_t back;                 // Buffer the interrupt assembles into, the other one is published
+  uint8_t index;                // Bytes assembled so far
+  uint8_t expectedLength;       // Free for the protocol to use
+  uint16_t check;               // Running checksum, free for the protocol to use
+  uint32_t lastByteTime;
+  volatile bool ready;          // Published frame not taken by read() yet
+  volatile uint8_t length;      // Length of the published frame
+
+  uint8_t *frame() { return buffer[back]; }
+  void store(uint8_t byte) { buffer[back][index++] = byte; }
+};
+
+// Counters shared by all decoders, since boot. The receive interrupt keeps
+// them, except lostFrames and failsafeFrames, which unpack() counts.
+struct RcLinkStats {
+  uint32_t lastFrameTime;       // halMillis() when the last valid frame arrived
+  uint32_t frames;              // Valid frames
+  uint32_t errors;              // Frames dropped on a bad checksum, footer or channel count
+  uint32_t resyncs;             // Started frames dropped on a byte that does not fit
+  uint32_t byteTimeouts;        // Started frames dropped after a gap longer than BYTE_TIMEOUT_MS
+  uint32_t overruns;            // Bytes or edges lost because they were not read in time
+  uint32_t lostFrames;          // Valid frames the receiver flagged as lost (SBUS)
+  uint32_t failsafeFrames;      // Valid frames the receiver sent in failsafe (SBUS)
+
+  // Time between valid frames since the last resetRcLinkIntervals(), in us.
+  // Longer intervals count as 0xFFFF. intervalMin is only set once
+  // intervalCount is not 0.
+  uint32_t lastFrameMicros;
+  uint16_t intervalMin;
+  uint16_t intervalMax;
+  uint32_t intervalTotal;
+  uint16_t intervalCount;
+
+  bool receiverFailsafe;        // The last frame carried the receiver's failsafe flag (SBUS)
+};
+
+extern RxFrames rcRx;
+extern volatile RcLinkStats rcLink;
+
+// Interrupt context bookkeeping, shared by the decoders. rcLinkFrame() is
+// out of line, it runs once per frame and would be copied into every decoder.
+void rcLinkFrame();
+
+inline void rcLinkError() {
+  rcLink.errors++;
+}
+
+inline void rcLinkOverrun() {
+  rcLink.overruns++;
+}
+
+// Copy out the published frame, false if there is none
+bool rxTake(uint8_t *frame);
+
+template <class Protocol>
+struct UartDecoder {
+  // Interrupt context
+  static void receive(uint8_t byte) {
+    uint32_t now = halMillis();
+    if (rcRx.index > 0 && (now - rcRx.lastByteTime) > Protocol::BYTE_TIMEOUT_MS) {
+      rcRx.index = 0;
+      rcLink.byteTimeouts++;
+    }
+    rcRx.lastByteTime = now;
+
+    switch (Protocol::receive(rcRx, byte)) {
+      case RX_FRAME:
+        rcRx.length = rcRx.index;
+        rcRx.back ^= 1;
+        rcRx.ready = true;
+        rcRx.index = 0;
+        rcLinkFrame();
+        break;
+      case RX_BAD:
+        rcRx.index = 0;
+        rcLinkError();
+        break;
+      case RX_DROP:
+        if (rcRx.index > 0) rcLink.resyncs++;
+        rcRx.index = 0;
+        break;
+      case RX_SKIP:
+        rcRx.index = 0;
+        break;
+    }
+  }
+
+  static void begin() {
+    rcRx.index = 0;
+    rcRx.ready = false;
+    halSerialBegin(Protocol::BAUD, Protocol::FORMAT, receive);
+
+    #ifdef DEBUG
+      halDebugPrint(Protocol::name());
+      halDebugPrint(" initialized at ");
+      halDebugPrint((int32_t)Protocol::BAUD);
+      halDebugPrintln(" baud");
+    #endif
+  }
+
+  static bool read() {
+    #ifdef DEBUG
+      static uint16_t lastErrors = 0;
+      if (rcLink.errors != lastErrors) {
+        lastErrors = rcLink.errors;
+        halDebugPrint(Protocol::name());
+        halDebugPrintln(": Checksum mismatch");
+      }
+    #endif
+
+    uint8_t frame[Protocol::FRAME_MAX];
+    if (!rxTake(frame)) return false;
+    return Protocol::unpack(frame);
+  }
+
+  static bool quiet() {
+    return rcRx.index == 0;
+  }
+};
+
+#endif // RC_DECODER_H
@@ -0,0 +1,69 @@
+#ifndef RC_INPUT_H
+#define RC_INPUT_H
+
+#include <stdint.h>
+#include "rc_decoder.h"
+
+extern uint16_t channelData[16]; // RC channel data (1000-2000)
+
+// Bind the decoder for config.protocol and start it, once at boot
+void beginRcInput();
+
+// Stop the decoder so beginRcInput() can bind another protocol
+void endRcInput();
+
+// True when the bound decoder unpacked a new frame into channelData
+bool readProtocol();
+
+// Same, but leaves the channels as the receiver sent them (filtered, not
+// conditioned), for calibration
+bool readRawProtocol();
+
+// True once beginRcInput() started a decoder
+bool rcInputRunning();
+
+// Protocol the input is receiving: config.protocol, or with AUTO the protocol
+// detection locked onto. 0 while detection is still searching, or before
+// beginRcInput().
+uint8_t rcInputProtocol();
+
+// Protocol auto detection (AUTO), see AutoDecoder in rc_input.cpp
+#define AUTO_LOCK_FRAMES 3      // Valid frames in a row, without a checksum error, that lock a candidate
+#define AUTO_RELOCK_MS   1000   // Time without a valid frame after which the search starts over
+#define AUTO_CYCLE_MS    300    // One pass over every candidate when none of them receives anything
+
+// True when no frame is on the wire right now (always true before beginRcInput())
+bool rcInputQuiet();
+
+// Milliseconds since the last valid frame
+uint32_t rcFrameAge();
+
+// Snapshot of the link counters, UART overruns included
+void readRcLinkStats(RcLinkStats *stats);
+
+// Start a new window for the frame interval stats
+void resetRcLinkIntervals();
+
+// One step of the CRSF CRC8 (DVB-S2, poly 0xD5), shared with the monitor stream
+uint8_t rcCrc8(uint8_t crc, uint8_t byte);
+
+// Fixed-point range conversions. rcScale(x, MUL, SHIFT) gives the same result
+// as Arduino's map() over the whole input range listed for each pair (checked
+// exhaustively), but costs a multiply and a constant shift instead of a 32-bit
+// division, which the ATmega32U4 does in software.
+#define RC_SCALE_11BIT_MUL 319883UL   // x * 1000 / 1639, x = 0-1639 (SBUS/CRSF/FPORT 172-1811)
+#define RC_SCALE_11BIT_SHIFT 19
+#define RC_SCALE_DSMX_MUL 1024501UL   // x * 1000 / 2047, x = 0-2047
+#define RC_SCALE_DSMX_SHIFT 21
+#define RC_SCALE_DSM2_MUL 64063UL     // x * 1000 / 1023, x = 0-1023
+#define RC_SCALE_DSM2_SHIFT 16
+#define RC_SCALE_AXIS_MUL 536347UL    // x * 1023 / 1000, x = 0-1000
+#define RC_SCALE_AXIS_SHIFT 19
+#define RC_SCALE_HAT_MUL 1049UL       // x * 8 / 1000, x = 0-1000
+#define RC_SCALE_HAT_SHIFT 17
+
+inline uint16_t rcScale(uint16_t x, uint32_t mul, uint8_t shift) {
+  return (uint16_t)((x * mul) >> shift);
+}
+
+#endif // RC_INPUT_H
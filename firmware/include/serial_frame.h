@@ -0,0 +1,30 @@
+#ifndef SERIAL_FRAME_H
+#define SERIAL_FRAME_H
+
+#include <stdint.h>
+
+/*
+Binary frames on the USB serial port
+
+Binary data shares the port with the text commands, so every binary frame is
+COBS encoded: the payload's zeros are replaced by the distance to the next
+one and a single 0x00 ends the frame. The host can always resync on a zero.
+The last payload byte is a CRC8 (DVB-S2, the CRSF check) over the rest.
+Payloads are shorter than 254 bytes, so encoding adds exactly two bytes.
+*/
+
+#define SERIAL_FRAME_OVERHEAD 2   // COBS code byte + delimiter
+
+// Binary frame types, first payload byte
+#define SERIAL_FRAME_MONITOR 0x01 // Live channels, see monitor.h
+#define SERIAL_FRAME_CONFIG  0x02 // JoystickConfig image, see config.h
+
+// Append the CRC8 to payload[0..length-1] and COBS encode it into out.
+// Returns the encoded length including the trailing 0x00.
+uint8_t encodeSerialFrame(uint8_t *payload, uint8_t length, uint8_t *out);
+
+// Decode a frame without its trailing 0x00 into payload and check its CRC.
+// Returns the payload length without the CRC, 0 if the frame is malformed.
+uint8_t decodeSerialFrame(const uint8_t *in, uint8_t length, uint8_t *payload);
+
+#endif // SERIAL_FRAME_H
@@ -0,0 +1,12 @@
+#ifndef STATUS_LED_H
+#define STATUS_LED_H
+
+#include <stdint.h>
+
+// Non-blocking LED utility functions
+void setLED(uint8_t r, uint8_t g, uint8_t b);
+void startFlashLED(uint8_t r, uint8_t g, uint8_t b, int count = 1);
+void startPulseLED(uint8_t r, uint8_t g, uint8_t b);
+void updateLED();
+
+#endif // STATUS_LED_H
@@ -0,0 +1,35 @@
+#include "boot_timing.h"
+#include "hal.h"
+
+static uint32_t phaseMicros[BOOT_PHASE_COUNT];
+static uint8_t phasesReached = 0;
+
+static const char nameSetup[] PROGMEM = "setup";
+static const char nameConfig[] PROGMEM = "config_loaded";
+static const char nameHid[] PROGMEM = "hid_created";
+static const char nameInput[] PROGMEM = "input_started";
+static const char nameUsb[] PROGMEM = "usb_configured";
+static const char nameFrame[] PROGMEM = "first_frame";
+static const char nameReport[] PROGMEM = "first_report";
+
+static const char *const phaseNames[BOOT_PHASE_COUNT] PROGMEM = {
+  nameSetup, nameConfig, nameHid, nameInput, nameUsb, nameFrame, nameReport
+};
+
+void markBootPhase(uint8_t phase) {
+  if (phasesReached & (1 << phase)) return;
+  phaseMicros[phase] = halMicros();
+  phasesReached |= 1 << phase;
+}
+
+bool bootPhaseReached(uint8_t phase) {
+  return phasesReached & (1 << phase);
+}
+
+uint32_t bootPhaseMicros(uint8_t phase) {
+  return phaseMicros[phase];
+}
+
+const char *bootPhaseName(uint8_t phase) {
+  return (const char *)pgm_read_ptr(&phaseNames[phase]);
+}
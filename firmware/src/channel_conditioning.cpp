@@ -0,0 +1,220 @@
+#include "channel_conditioning.h"
+#include "config.h"
+#include "hal.h"
+#include "rc_input.h"
+
+/*
+Channel conditioning
+
+Turns a channel as the receiver sends it into the 1000-2000 range the
+mapping expects, using the calibrated endpoints and centre of that channel:
+
+  1. clamp to [min, max]
+  2. distance from centre, minus the deadband (inside it: centre)
+  3. scale that side of the stick to 0-4096 with a precomputed multiplier
+  4. shape it through the curve table (expo), giving 0-500
+  5. 1500 +/- the result, swapped when reversed
+
+Everything that depends on the settings is worked out in
+beginChannelConditioning(), so the per-frame cost is one multiply and one
+table interpolation per conditioned channel, whatever the curve looks like.
+Channels left at the default calibration are not touched at all.
+
+Curves are 17 point tables over 0-4096 (segments of 256), interpolated
+linearly. The expo curve is (1 - e) * x + e * x^3, which a 16 segment table
+follows to within 2us at full expo.
+*/
+
+#define CURVE_POINTS 17
+#define CURVE_SEGMENT_BITS 8      // 256 input steps per segment
+#define SCALE_BITS 8              // Fraction bits of the side multipliers
+#define NORMALIZED_MAX 4096
+#define NO_CURVE 0xFF
+
+struct ConditionedChannel {
+  uint8_t channel;              // Index into channelData
+  uint8_t deadband;
+  bool reverse;
+  uint8_t curve;                // Index into curves, NO_CURVE = straight line
+  uint16_t min;
+  uint16_t center;
+  uint16_t max;
+  uint16_t lowScale;            // 0-4096 per us below centre, SCALE_BITS fraction bits
+  uint16_t highScale;           // Same above centre
+};
+
+static ConditionedChannel conditioned[16];
+static uint8_t conditionedCount = 0;
+
+static uint16_t curves[CONDITIONING_CURVES_MAX][CURVE_POINTS];
+static uint8_t curveExpo[CONDITIONING_CURVES_MAX];
+static uint8_t curveCount = 0;
+
+// Multiplier that takes span us to NORMALIZED_MAX
+static uint16_t sideScale(uint16_t span) {
+  if (span < 1) span = 1;
+  uint32_t scale = (((uint32_t)NORMALIZED_MAX << SCALE_BITS) + span / 2) / span;
+  return scale > 0xFFFF ? 0xFFFF : scale;
+}
+
+// Curve table for an expo in percent, points in 0-500
+static uint8_t curveFor(uint8_t expo) {
+  if (expo == 0) return NO_CURVE;
+  for (uint8_t i = 0; i < curveCount; i++) {
+    if (curveExpo[i] == expo) return i;
+  }
+  if (curveCount >= CONDITIONING_CURVES_MAX) {
+    #ifdef DEBUG
+      halDebugPrintln("Too many expo curves, using a straight line");
+    #endif
+    return NO_CURVE;
+  }
+
+  uint16_t *curve = curves[curveCount];
+  for (uint8_t k = 0; k < CURVE_POINTS; k++) {
+    // 500 * ((100 - e) * k / 16 + e * (k / 16)^3) / 100
+    uint32_t shaped = (uint32_t)(100 - expo) * k * 256 + (uint32_t)expo * k * k * k;
+    curve[k] = (5 * shaped + 2048) / 4096;
+  }
+  curveExpo[curveCount] = expo;
+  return curveCount++;
+}
+
+uint8_t conditioningCurvesNeeded() {
+  uint8_t expos[16];
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < 16; i++) {
+    uint8_t expo = settings.calibration[i].expo;
+    if (expo == 0) continue;
+    uint8_t j = 0;
+    while (j < count && expos[j] != expo) j++;
+    if (j == count) expos[count++] = expo;
+  }
+  return count;
+}
+
+void beginChannelConditioning() {
+  conditionedCount = 0;
+  curveCount = 0;
+  for (uint8_t i = 0; i < 16; i++) {
+    const ChannelCalibration &cal = settings.calibration[i];
+    if (isDefaultCalibration(cal)) continue;
+
+    ConditionedChannel &c = conditioned[conditionedCount++];
+    c.channel = i;
+    c.deadband = cal.deadband;
+    c.reverse = cal.reverse;
+    c.curve = curveFor(cal.expo);
+    c.min = cal.min;
+    c.center = cal.center;
+    c.max = cal.max;
+    c.lowScale = sideScale(cal.center - cal.deadband - cal.min);
+    c.highScale = sideScale(cal.max - cal.center - cal.deadband);
+  }
+}
+
+void conditionChannels() {
+  for (uint8_t i = 0; i < conditionedCount; i++) {
+    const ConditionedChannel &c = conditioned[i];
+    uint16_t value = channelData[c.channel];
+    if (value < c.min) value = c.min;
+    if (value > c.max) value = c.max;
+
+    bool low = value < c.center;
+    uint16_t distance = low ? c.center - value : value - c.center;
+    if (distance <= c.deadband) {
+      channelData[c.channel] = 1500;
+      continue;
+    }
+    distance -= c.deadband;
+
+    uint16_t scale = low ? c.lowScale : c.highScale;
+    uint16_t normalized = ((uint32_t)distance * scale + (1 << (SCALE_BITS - 1))) >> SCALE_BITS;
+    if (normalized > NORMALIZED_MAX) normalized = NORMALIZED_MAX;
+
+    uint16_t shaped;
+    if (c.curve == NO_CURVE) {
+      shaped = ((uint32_t)normalized * 125 + 512) >> 10;      // * 500 / 4096
+    } else {
+      const uint16_t *curve = curves[c.curve];
+      uint8_t segment = normalized >> CURVE_SEGMENT_BITS;
+      uint8_t fraction = normalized & ((1 << CURVE_SEGMENT_BITS) - 1);
+      shaped = curve[segment];
+      if (fraction) {
+        uint16_t rise = (curve[segment + 1] - curve[segment]) * fraction;
+        shaped += (rise + (1 << (CURVE_SEGMENT_BITS - 1))) >> CURVE_SEGMENT_BITS;
+      }
+    }
+
+    if (low != c.reverse) {
+      channelData[c.channel] = 1500 - shaped;
+    } else {
+      channelData[c.channel] = 1500 + shaped;
+    }
+  }
+}
+
+/*
+Calibration capture
+
+While the operator moves every stick to its endpoints and then lets it
+settle at centre, each frame widens the channel's min/max and pulls a short
+running average towards the current value. At the end that average is the
+centre. Channels whose centre is not clear of both endpoints (switches,
+throttles without a spring) get the midpoint instead.
+*/
+
+#define CAL_CENTER_FRACTION_BITS 2
+
+CalibrationCapture calibrationCapture;
+
+void startCalibrationCapture() {
+  for (uint8_t i = 0; i < 16; i++) {
+    calibrationCapture.min[i] = 0xFFFF;
+    calibrationCapture.max[i] = 0;
+  }
+  calibrationCapture.frames = 0;
+}
+
+void captureCalibrationFrame() {
+  CalibrationCapture &cap = calibrationCapture;
+  for (uint8_t i = 0; i < 16; i++) {
+    uint16_t value = channelData[i];
+    if (value < cap.min[i]) cap.min[i] = value;
+    if (value > cap.max[i]) cap.max[i] = value;
+    uint16_t scaled = value << CAL_CENTER_FRACTION_BITS;
+    if (cap.frames == 0) {
+      cap.center[i] = scaled;
+    } else {
+      cap.center[i] += ((int16_t)(scaled - cap.center[i])) >> CAL_CENTER_FRACTION_BITS;
+    }
+  }
+  if (cap.frames < 0xFFFF) cap.frames++;
+}
+
+uint16_t finishCalibrationCapture() {
+  const CalibrationCapture &cap = calibrationCapture;
+  uint16_t written = 0;
+  if (cap.frames == 0) return 0;
+
+  for (uint8_t i = 0; i < 16; i++) {
+    if (cap.max[i] < cap.min[i] + CAL_MIN_TRAVEL) continue;
+
+    ChannelCalibration &cal = settings.calibration[i];
+    uint16_t min = cap.min[i] < CAL_LIMIT_MIN ? CAL_LIMIT_MIN : cap.min[i];
+    uint16_t max = cap.max[i] > CAL_LIMIT_MAX ? CAL_LIMIT_MAX : cap.max[i];
+    uint16_t center = (cap.center[i] + (1 << (CAL_CENTER_FRACTION_BITS - 1))) >> CAL_CENTER_FRACTION_BITS;
+    uint16_t clearance = cal.deadband + CAL_MIN_SPAN;
+
+    if (center < min + clearance || center + clearance > max) {
+      center = (min + max) / 2;
+    }
+    if (center < min + clearance || center + clearance > max) continue;
+
+    cal.min = min;
+    cal.center = center;
+    cal.max = max;
+    written |= (uint16_t)1 << i;
+  }
+  return written;
+}
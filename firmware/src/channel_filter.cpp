@@ -0,0 +1,85 @@
+#include "channel_filter.h"
+#include "config.h"
+#include "rc_input.h"
+
+/*
+Adaptive channel filter
+
+A One-Euro style low-pass in fixed point, run once per frame on the channels
+that have it enabled. Each frame the output moves towards the input by
+alpha/256:
+
+  alpha = cutoff + beta * speed / 16      (speed in us per frame, capped at 256)
+
+speed is the smoothed signed change of the input, so receiver noise averages
+out and a still stick gets the heavy smoothing set by cutoff, while a moving
+stick opens the filter up and adds almost no lag. Values are kept with 4
+fractional bits, and the part of each step below that is carried over to
+the next frame, so the output settles on the input from either side instead
+of stopping short when the step rounds to zero. The cost is a fixed handful
+of multiplies per enabled channel, and nothing for the channels that are
+off.
+
+The filter runs per frame, not per millisecond, so the same settings smooth
+more on fast protocols (CRSF at 4ms) than on slow ones (PPM at 22ms).
+*/
+
+#define FILTER_FRACTION_BITS 4
+#define FILTER_SPEED_SHIFT 2      // Smoothing of the speed estimate, 1/4 per frame
+
+struct ChannelFilter {
+  uint8_t channel;              // Index into channelData
+  uint8_t cutoff;
+  uint8_t beta;
+  bool primed;                  // First frame seen
+  uint8_t carry;                // Fraction of the output step left over, in 1/256
+  uint32_t input;               // Previous input
+  uint32_t output;
+  int32_t speed;                // Smoothed change per frame
+};
+
+static ChannelFilter filters[16];
+static uint8_t filterCount = 0;
+
+void beginChannelFilter() {
+  filterCount = 0;
+  for (uint8_t i = 0; i < 16; i++) {
+    if (settings.filterCutoff[i] == 0) continue;
+    ChannelFilter &f = filters[filterCount++];
+    f.channel = i;
+    f.cutoff = settings.filterCutoff[i];
+    f.beta = settings.filterBeta[i];
+    f.primed = false;
+  }
+}
+
+void filterChannels() {
+  for (uint8_t i = 0; i < filterCount; i++) {
+    ChannelFilter &f = filters[i];
+    // 32 bits, so unclamped IBUS values (up to 65535) keep their range
+    uint32_t input = (uint32_t)channelData[f.channel] << FILTER_FRACTION_BITS;
+
+    if (!f.primed) {
+      f.primed = true;
+      f.input = f.output = input;
+      f.speed = 0;
+      f.carry = 0;
+      continue;
+    }
+
+    // Every difference is taken in int32_t to keep its sign
+    int32_t change = (int32_t)input - (int32_t)f.input;
+    f.input = input;
+    f.speed += (change - f.speed) >> FILTER_SPEED_SHIFT;
+
+    uint32_t speed = (f.speed < 0) ? -f.speed : f.speed;
+    uint32_t alpha = f.cutoff + (((uint32_t)f.beta * speed) >> (FILTER_FRACTION_BITS + 4));
+    if (alpha > 256) alpha = 256;
+
+    // The shift rounds down, the carry keeps what it dropped
+    int32_t step = ((int32_t)input - (int32_t)f.output) * (int32_t)alpha + f.carry;
+    f.output += step >> 8;
+    f.carry = step & 0xFF;
+    channelData[f.channel] = (f.output + (1 << (FILTER_FRACTION_BITS - 1))) >> FILTER_FRACTION_BITS;
+  }
+}
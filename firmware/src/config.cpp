@@ -0,0 +1,246 @@
+#include <stddef.h>
+#include <string.h>
+#include "config.h"
+#include "hal.h"
+#include "serial_frame.h"
+
+JoystickConfig config;
+DeviceSettings settings;
+
+// Slot and sequence of the record loaded or saved last. Until there is one
+// the first save goes to slot 0.
+static uint8_t storeSlot = STORE_SLOTS - 1;
+static uint16_t storeSequence = 0;
+
+static uint16_t slotAddress(uint8_t slot) {
+  return slot * STORE_SLOT_SIZE;
+}
+
+// CRC of a record as it sits in EEPROM, read back in small pieces
+static uint16_t storedRecordCrc(uint8_t slot, const StoreHeader &header) {
+  uint16_t crc = 0xFFFF;
+  const uint8_t *bytes = (const uint8_t *)&header;
+  for (uint8_t i = 0; i < offsetof(StoreHeader, crc); i++) {
+    crc = crc16Update(crc, bytes[i]);
+  }
+
+  uint8_t chunk[16];
+  uint16_t addr = slotAddress(slot) + sizeof(StoreHeader);
+  for (uint16_t done = 0; done < header.length; ) {
+    uint16_t left = header.length - done;
+    uint8_t n = left < sizeof(chunk) ? left : sizeof(chunk);
+    halStoreRead(addr + done, chunk, n);
+    for (uint8_t i = 0; i < n; i++) {
+      crc = crc16Update(crc, chunk[i]);
+    }
+    done += n;
+  }
+  return crc;
+}
+
+static bool readRecordHeader(uint8_t slot, StoreHeader *header) {
+  halStoreRead(slotAddress(slot), header, sizeof(StoreHeader));
+  return header->magic == STORE_MAGIC && header->version == STORE_VERSION &&
+         header->length >= sizeof(JoystickConfig) &&
+         header->length <= STORE_SLOT_SIZE - sizeof(StoreHeader) &&
+         header->crc == storedRecordCrc(slot, *header);
+}
+
+static void loadRecord(uint8_t slot, const StoreHeader &header) {
+  uint16_t addr = slotAddress(slot) + sizeof(StoreHeader);
+  halStoreRead(addr, &config, sizeof(config));
+
+  // Settings the record does not have yet keep their defaults
+  generateDefaultSettings();
+  uint16_t size = header.length - sizeof(config);
+  halStoreRead(addr + sizeof(config), &settings, size < sizeof(settings) ? size : sizeof(settings));
+  settings.signature = EEPROM_SETTINGS_SIGNATURE;
+  settings.size = sizeof(settings);
+}
+
+// The layout before the record store: signature, JoystickConfig, then the
+// optional settings block with its own signature and size
+static bool loadLegacyConfig() {
+  uint32_t signature;
+  halStoreRead(EEPROM_SIGNATURE_ADDR, &signature, sizeof(signature));
+  if (signature != EEPROM_SIGNATURE) return false;
+
+  halStoreRead(EEPROM_CONFIG_START_ADDR, &config, sizeof(config));
+
+  generateDefaultSettings();
+  DeviceSettings stored;
+  halStoreRead(EEPROM_SETTINGS_ADDR, &stored, sizeof(stored));
+  if (stored.signature == EEPROM_SETTINGS_SIGNATURE) {
+    uint8_t size = stored.size < sizeof(settings) ? stored.size : sizeof(settings);
+    halStoreRead(EEPROM_SETTINGS_ADDR, &settings, size);
+    settings.size = sizeof(settings);
+  }
+  return true;
+}
+
+bool loadConfigFromEEPROM() {
+  int8_t newest = -1;
+  StoreHeader newestHeader;
+  for (uint8_t slot = 0; slot < STORE_SLOTS; slot++) {
+    StoreHeader header;
+    if (!readRecordHeader(slot, &header)) continue;
+    if (newest < 0 || (int16_t)(header.sequence - newestHeader.sequence) > 0) {
+      newest = slot;
+      newestHeader = header;
+    }
+  }
+
+  if (newest >= 0) {
+    loadRecord(newest, newestHeader);
+    storeSlot = newest;
+    storeSequence = newestHeader.sequence;
+    return true;
+  }
+
+  // First boot after the upgrade. The old block overlaps slot 0, so the
+  // record goes to slot 1 and the old block stays readable until it is safe.
+  if (loadLegacyConfig()) {
+    storeSlot = 0;
+    storeSequence = 0;
+    saveConfigToEEPROM();
+    return true;
+  }
+  return false;
+}
+
+bool saveConfigToEEPROM() {
+  uint8_t slot = (storeSlot + 1) % STORE_SLOTS;
+  uint16_t addr = slotAddress(slot);
+
+  StoreHeader header;
+  header.magic = STORE_MAGIC;
+  header.version = STORE_VERSION;
+  header.reserved = 0;
+  header.sequence = storeSequence + 1;
+  header.length = sizeof(config) + sizeof(settings);
+
+  // Payload first, the header that makes it valid last
+  halStoreWrite(addr + sizeof(StoreHeader), &config, sizeof(config));
+  halStoreWrite(addr + sizeof(StoreHeader) + sizeof(config), &settings, sizeof(settings));
+  header.crc = storedRecordCrc(slot, header);
+  halStoreWrite(addr, &header, sizeof(header));
+
+  StoreHeader written;
+  if (!readRecordHeader(slot, &written) || written.sequence != header.sequence) return false;
+  storeSlot = slot;
+  storeSequence = header.sequence;
+  return true;
+}
+
+void generateDefaultConfig() {
+  config.protocol = IBUS;
+  config.x_axis = 1;          // Channel 1
+  config.y_axis = 2;          // Channel 2
+  config.ry_axis = 3;         // Channel 3
+  config.rx_axis = 4;         // Channel 4
+  config.rz_axis = 7;         // Channel 7
+  config.z_axis = 0;          // Disabled
+  config.rudder = 0;          // Disabled
+  config.throttle = 0;        // Disabled
+  config.accelerator = 0;     // Disabled
+  config.brake = 0;           // Disabled
+  config.steering = 0;        // Disabled
+
+  config.hat_switch1 = 0;     // Disabled
+  config.hat_switch2 = 0;     // Disabled
+
+  // Set up buttons
+  config.buttons[0] = 5;      // Button 1 -> Channel 5
+  config.buttons[1] = 6;      // Button 2 -> Channel 6
+  config.buttons[2] = 8;      // Button 3 -> Channel 8
+
+  // Rest of buttons disabled
+  for (int i = 3; i < 32; i++) {
+    config.buttons[i] = 0;    // Disabled
+  }
+
+  generateDefaultSettings();
+}
+
+void generateClearConfig() {
+  config.protocol = IBUS;
+  config.x_axis = 0;
+  config.y_axis = 0;
+  config.ry_axis = 0;
+  config.rx_axis = 0;
+  config.rz_axis = 0;
+  config.z_axis = 0;
+  config.rudder = 0;
+  config.throttle = 0;
+  config.accelerator = 0;
+  config.brake = 0;
+  config.steering = 0;
+
+  config.hat_switch1 = 0;
+  config.hat_switch2 = 0;
+
+  for (int i = 0; i < 32; i++) {
+    config.buttons[i] = 0;
+  }
+}
+
+void generateDefaultCalibration(ChannelCalibration *cal) {
+  cal->min = 1000;
+  cal->center = 1500;
+  cal->max = 2000;
+  cal->deadband = 0;
+  cal->expo = 0;
+  cal->reverse = 0;
+}
+
+bool isDefaultCalibration(const ChannelCalibration &cal) {
+  return cal.min == 1000 && cal.center == 1500 && cal.max == 2000 &&
+         cal.deadband == 0 && cal.expo == 0 && cal.reverse == 0;
+}
+
+void generateDefaultSettings() {
+  settings.signature = EEPROM_SETTINGS_SIGNATURE;
+  settings.size = sizeof(settings);
+  settings.reportMinInterval = DEFAULT_REPORT_MIN_INTERVAL;
+  settings.reportKeepAlive = DEFAULT_REPORT_KEEPALIVE;
+  for (int i = 0; i < 16; i++) {
+    settings.filterCutoff[i] = DEFAULT_FILTER_CUTOFF;
+    settings.filterBeta[i] = DEFAULT_FILTER_BETA;
+    generateDefaultCalibration(&settings.calibration[i]);
+  }
+
+  // Failsafe on, but every control holds, as before there was a failsafe
+  settings.failsafeTimeout = DEFAULT_FAILSAFE_TIMEOUT;
+  for (uint8_t i = 0; i < FAILSAFE_AXES; i++) settings.failsafeAxes[i] = 0;
+  settings.failsafeHats[0] = settings.failsafeHats[1] = FAILSAFE_HOLD;
+  settings.failsafeLostButton = 0;
+  for (uint8_t i = 0; i < 8; i++) settings.failsafeButtons[i] = 0; // FAILSAFE_HOLD
+}
+
+// Writes CONFIG_IMAGE_SIZE bytes, returns that length
+uint8_t packConfigImage(uint8_t *payload) {
+  payload[0] = SERIAL_FRAME_CONFIG;
+  payload[1] = CONFIG_IMAGE_VERSION;
+  payload[2] = sizeof(JoystickConfig);
+  memcpy(&payload[3], &config, sizeof(JoystickConfig));
+  return CONFIG_IMAGE_SIZE;
+}
+
+// Replaces config with the image if it is complete, the same version and
+// every field is in range. Leaves config alone otherwise.
+bool unpackConfigImage(const uint8_t *payload, uint8_t length) {
+  if (length != CONFIG_IMAGE_SIZE || payload[0] != SERIAL_FRAME_CONFIG ||
+      payload[1] != CONFIG_IMAGE_VERSION || payload[2] != sizeof(JoystickConfig)) {
+    return false;
+  }
+
+  const uint8_t *image = &payload[3];
+  if (image[0] < IBUS || image[0] > AUTO) return false;
+  // Every other field is a channel number
+  for (uint8_t i = 1; i < sizeof(JoystickConfig); i++) {
+    if (image[i] > 16) return false;
+  }
+
+  memcpy(&config, image, sizeof(JoystickConfig));
+  return true;
+}
@@ -0,0 +1,217 @@
+#include <stddef.h>
+#include <string.h>
+#include "config_fields.h"
+#include "config.h"
+#include "hal.h"
+#include "channel_conditioning.h"
+
+#define CONFIG_AT(field) offsetof(JoystickConfig, field)
+#define SETTINGS_AT(field) offsetof(DeviceSettings, field)
+#define CAL_AT(field) (offsetof(DeviceSettings, calibration) + offsetof(ChannelCalibration, field))
+
+#define FIELD(name, section, flags, offset, count, stride, min, max, idle) \
+  { name, configFieldHash(name), section, flags, offset, count, stride, min, max, idle }
+#define CHANNEL(name, section, field) FIELD(name, section, 0, CONFIG_AT(field), 1, 0, 0, 16, 0)
+#define CAL(name, flags, field, min, max, idle) \
+  FIELD(name, SECTION_CALIBRATION, FIELD_SETTINGS | (flags), CAL_AT(field), 16, sizeof(ChannelCalibration), min, max, idle)
+// 0 = hold, anything else is the channel value the axis goes to
+#define FAILSAFE_AXIS(name, axis) \
+  FIELD(name, SECTION_FAILSAFE, FIELD_SETTINGS | FIELD_WORD | FIELD_ZERO_OFF, \
+        SETTINGS_AT(failsafeAxes) + (axis) * sizeof(uint16_t), 1, 0, 1000, 2000, 0)
+
+static const ConfigField configFields[] PROGMEM = {
+  FIELD("protocol", SECTION_GENERAL, FIELD_PROTOCOL, CONFIG_AT(protocol), 1, 0, IBUS, AUTO, 0),
+
+  CHANNEL("x_axis", SECTION_AXES, x_axis),
+  CHANNEL("y_axis", SECTION_AXES, y_axis),
+  CHANNEL("z_axis", SECTION_AXES, z_axis),
+  CHANNEL("rx_axis", SECTION_AXES, rx_axis),
+  CHANNEL("ry_axis", SECTION_AXES, ry_axis),
+  CHANNEL("rz_axis", SECTION_AXES, rz_axis),
+  CHANNEL("rudder", SECTION_AXES, rudder),
+  CHANNEL("throttle", SECTION_AXES, throttle),
+  CHANNEL("accelerator", SECTION_AXES, accelerator),
+  CHANNEL("brake", SECTION_AXES, brake),
+  CHANNEL("steering", SECTION_AXES, steering),
+
+  CHANNEL("hat_switch_1", SECTION_HATS, hat_switch1),
+  CHANNEL("hat_switch_2", SECTION_HATS, hat_switch2),
+
+  FIELD("button", SECTION_BUTTONS, 0, CONFIG_AT(buttons), 32, 1, 0, 16, 0),
+
+  FIELD("report_interval", SECTION_REPORTS, FIELD_SETTINGS | FIELD_WORD, SETTINGS_AT(reportMinInterval),
+        1, 0, 0, 65535, DEFAULT_REPORT_MIN_INTERVAL),
+  FIELD("report_keepalive", SECTION_REPORTS, FIELD_SETTINGS | FIELD_WORD, SETTINGS_AT(reportKeepAlive),
+        1, 0, 0, 65535, DEFAULT_REPORT_KEEPALIVE),
+
+  FIELD("filter", SECTION_FILTERS, FIELD_SETTINGS, SETTINGS_AT(filterCutoff), 16, 1, 0, 255, DEFAULT_FILTER_CUTOFF),
+  FIELD("filter_beta", SECTION_FILTERS, FIELD_SETTINGS, SETTINGS_AT(filterBeta), 16, 1, 0, 255, DEFAULT_FILTER_BETA),
+
+  CAL("cal_min", FIELD_CALIBRATION | FIELD_WORD, min, CAL_LIMIT_MIN, CAL_LIMIT_MAX, 1000),
+  CAL("cal_center", FIELD_CALIBRATION | FIELD_WORD, center, CAL_LIMIT_MIN, CAL_LIMIT_MAX, 1500),
+  CAL("cal_max", FIELD_CALIBRATION | FIELD_WORD, max, CAL_LIMIT_MIN, CAL_LIMIT_MAX, 2000),
+  CAL("deadband", FIELD_CALIBRATION, deadband, 0, 255, 0),
+  CAL("expo", FIELD_CALIBRATION, expo, 0, 100, 0),
+  CAL("reverse", 0, reverse, 0, 1, 0),
+
+  FIELD("fs_timeout", SECTION_FAILSAFE, FIELD_SETTINGS | FIELD_WORD, SETTINGS_AT(failsafeTimeout),
+        1, 0, 0, 65535, DEFAULT_FAILSAFE_TIMEOUT),
+  FIELD("fs_lost_button", SECTION_FAILSAFE, FIELD_SETTINGS, SETTINGS_AT(failsafeLostButton), 1, 0, 0, 32, 0),
+  FAILSAFE_AXIS("fs_x_axis", HID_AXIS_X),
+  FAILSAFE_AXIS("fs_y_axis", HID_AXIS_Y),
+  FAILSAFE_AXIS("fs_z_axis", HID_AXIS_Z),
+  FAILSAFE_AXIS("fs_rx_axis", HID_AXIS_RX),
+  FAILSAFE_AXIS("fs_ry_axis", HID_AXIS_RY),
+  FAILSAFE_AXIS("fs_rz_axis", HID_AXIS_RZ),
+  FAILSAFE_AXIS("fs_rudder", HID_AXIS_RUDDER),
+  FAILSAFE_AXIS("fs_throttle", HID_AXIS_THROTTLE),
+  FAILSAFE_AXIS("fs_accelerator", HID_AXIS_ACCELERATOR),
+  FAILSAFE_AXIS("fs_brake", HID_AXIS_BRAKE),
+  FAILSAFE_AXIS("fs_steering", HID_AXIS_STEERING),
+  FIELD("fs_hat_switch_1", SECTION_FAILSAFE, FIELD_SETTINGS, SETTINGS_AT(failsafeHats), 1, 0, 0, 1, 0),
+  FIELD("fs_hat_switch_2", SECTION_FAILSAFE, FIELD_SETTINGS, SETTINGS_AT(failsafeHats) + 1, 1, 0, 0, 1, 0),
+
+  FIELD("fs_button", SECTION_FAILSAFE_BUTTONS, FIELD_SETTINGS | FIELD_2BIT, SETTINGS_AT(failsafeButtons),
+        32, 0, 0, 2, FAILSAFE_HOLD),
+};
+
+const uint8_t configFieldCount = sizeof(configFields) / sizeof(configFields[0]);
+
+static const char titleAxes[] PROGMEM = "Axes";
+static const char titleHats[] PROGMEM = "Hat Switches";
+static const char titleButtons[] PROGMEM = "Buttons";
+static const char titleReports[] PROGMEM = "Reports";
+static const char titleFilters[] PROGMEM = "Filters";
+static const char titleCalibration[] PROGMEM = "Calibration";
+static const char titleFailsafe[] PROGMEM = "Failsafe";
+static const char titleFailsafeButtons[] PROGMEM = "Failsafe Buttons";
+
+static const char *const sectionTitles[SECTION_COUNT] PROGMEM = {
+  nullptr, titleAxes, titleHats, titleButtons, titleReports, titleFilters, titleCalibration,
+  titleFailsafe, titleFailsafeButtons
+};
+
+static const char noteGeneral[] PROGMEM = "Protocol (ppm_icp = PPM on pin 4, auto = detect):";
+static const char noteChannel[] PROGMEM = "Channel 1-16, 0=disable";
+static const char noteReports[] PROGMEM = "ms, min gap 0=none, keep-alive 0=off";
+static const char noteFilters[] PROGMEM = "Smoothing at rest 1=heaviest 0=off, beta = speed response";
+static const char noteCalibration[] PROGMEM = "Endpoints and deadband in us, expo in %";
+static const char noteFailsafe[] PROGMEM =
+  "Timeout ms 0=off, lost button 1-32 0=none, axes 0=hold 1000-2000=position, hats 0=hold 1=centre";
+static const char noteFailsafeButtons[] PROGMEM = "0=hold 1=release 2=press";
+
+static const char *const sectionNotes[SECTION_COUNT] PROGMEM = {
+  noteGeneral, noteChannel, noteChannel, noteChannel, noteReports, noteFilters, noteCalibration,
+  noteFailsafe, noteFailsafeButtons
+};
+
+// Indexed by protocol id - 1
+static const char protocolNames[][8] PROGMEM = {
+  "ibus", "sbus", "crsf", "dsmx", "dsm2", "fport", "ppm", "ppm_icp", "auto"
+};
+
+void readConfigField(uint8_t id, ConfigField *field) {
+  memcpy_P(field, &configFields[id], sizeof(ConfigField));
+}
+
+static int8_t findEntry(const char *name, bool perChannel) {
+  uint16_t hash = configFieldHash(name);
+  for (uint8_t i = 0; i < configFieldCount; i++) {
+    const ConfigField *entry = &configFields[i];
+    if (pgm_read_word(&entry->hash) != hash) continue;
+    if ((pgm_read_byte(&entry->count) > 1) != perChannel) continue;
+    if (strcmp_P(name, entry->name) == 0) return i;
+  }
+  return -1;
+}
+
+int8_t findConfigField(const char *name, uint8_t *index) {
+  *index = 0;
+  int8_t id = findEntry(name, false);
+  if (id >= 0) return id;
+
+  // Per-channel field: split off the _<n>
+  const char *suffix = strrchr(name, '_');
+  if (!suffix || !suffix[1] || suffix - name >= FIELD_NAME_MAX) return -1;
+  uint16_t n = 0;
+  for (const char *c = suffix + 1; *c; c++) {
+    if (*c < '0' || *c > '9') return -1;
+    if (n < 1000) n = n * 10 + (*c - '0');
+  }
+  *index = (n >= 1 && n <= 255) ? n - 1 : 0xFF;
+
+  char base[FIELD_NAME_MAX];
+  memcpy(base, name, suffix - name);
+  base[suffix - name] = '\0';
+  return findEntry(base, true);
+}
+
+static uint8_t *fieldAddress(const ConfigField &field, uint8_t index) {
+  uint8_t *base = (field.flags & FIELD_SETTINGS) ? (uint8_t *)&settings : (uint8_t *)&config;
+  if (field.flags & FIELD_2BIT) return base + field.offset + index / 4;
+  return base + field.offset + index * field.stride;
+}
+
+uint16_t getConfigField(const ConfigField &field, uint8_t index) {
+  const uint8_t *value = fieldAddress(field, index);
+  if (field.flags & FIELD_2BIT) return (*value >> ((index & 3) * 2)) & 3;
+  return (field.flags & FIELD_WORD) ? *(const uint16_t *)value : *value;
+}
+
+bool configFieldAccepts(const ConfigField &field, uint16_t value) {
+  if (value == 0 && (field.flags & FIELD_ZERO_OFF)) return true;
+  return value >= field.min && value <= field.max;
+}
+
+static void storeConfigField(const ConfigField &field, uint8_t index, uint16_t value) {
+  uint8_t *address = fieldAddress(field, index);
+  if (field.flags & FIELD_2BIT) {
+    uint8_t shift = (index & 3) * 2;
+    *address = (*address & ~(3 << shift)) | (value << shift);
+  } else if (field.flags & FIELD_WORD) {
+    *(uint16_t *)address = value;
+  } else {
+    *address = value;
+  }
+}
+
+uint8_t setConfigField(const ConfigField &field, uint8_t index, uint16_t value) {
+  if (!(field.flags & FIELD_CALIBRATION)) {
+    storeConfigField(field, index, value);
+    return FIELD_SET_OK;
+  }
+
+  ChannelCalibration &cal = settings.calibration[index];
+  ChannelCalibration previous = cal;
+  storeConfigField(field, index, value);
+  if (cal.min + cal.deadband + CAL_MIN_SPAN > cal.center ||
+      cal.center + cal.deadband + CAL_MIN_SPAN > cal.max) {
+    cal = previous;
+    return FIELD_SET_SPAN;
+  }
+  if (conditioningCurvesNeeded() > CONDITIONING_CURVES_MAX) {
+    cal = previous;
+    return FIELD_SET_CURVES;
+  }
+  return FIELD_SET_OK;
+}
+
+const char *configSectionTitle(uint8_t section) {
+  return (const char *)pgm_read_ptr(&sectionTitles[section]);
+}
+
+const char *configSectionNote(uint8_t section) {
+  return (const char *)pgm_read_ptr(&sectionNotes[section]);
+}
+
+const char *protocolName(uint8_t protocol) {
+  if (protocol < IBUS || protocol > AUTO) return nullptr;
+  return protocolNames[protocol - IBUS];
+}
+
+uint8_t findProtocol(const char *name) {
+  for (uint8_t i = 0; i < sizeof(protocolNames) / sizeof(protocolNames[0]); i++) {
+    if (strcmp_P(name, protocolNames[i]) == 0) return IBUS + i;
+  }
+  return 0;
+}
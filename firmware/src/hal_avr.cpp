@@ -0,0 +1,289 @@
+// HAL implementation for the Arduino Pro Micro (ATmega32U4)
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <Joystick.h>
+#include <Adafruit_NeoPixel.h>
+#include "hal.h"
+
+#define PPM_PIN 0            // PPM input on RX pin (Pin 0)
+#define PPM_CAPTURE_PIN 4    // PPM input on ICP1 (PD4) for the Timer1 capture engine
+
+// WS2812 LED pin
+#define WS2812_LED_PIN 5
+#define NUM_PIXELS 1
+
+// NeoPixel strip object
+static Adafruit_NeoPixel strip = Adafruit_NeoPixel(NUM_PIXELS, WS2812_LED_PIN, NEO_GRB + NEO_KHZ800);
+
+// Joystick object - only initialized in joystick mode to save RAM
+static Joystick_ *joystick = nullptr;
+
+static void (*serialHandler)(uint8_t byte) = nullptr;
+static volatile uint32_t serialOverruns = 0;
+
+static void (*captureHandler)(uint16_t ticks) = nullptr;
+static uint16_t lastCapture = 0;
+static volatile uint8_t captureOverflows = 0; // Timer1 overflows since lastCapture, saturates at 2
+
+static void (*tickHandler)() = nullptr;
+
+uint32_t halMillis() {
+  return millis();
+}
+
+uint32_t halMicros() {
+  return micros();
+}
+
+// USART1 is driven directly instead of through Serial1, so each byte reaches
+// the decoder from the RX interrupt rather than through the core's ring
+// buffer. Nothing references Serial1, so HardwareSerial1 and its own
+// USART1_RX_vect are not linked in.
+ISR(USART1_RX_vect) {
+  uint8_t status = UCSR1A;
+  uint8_t byte = UDR1;
+  if (status & _BV(DOR1)) serialOverruns++; // A byte before this one was lost
+  if (status & _BV(UPE1)) return; // Parity error, dropped like HardwareSerial does
+  if (serialHandler) serialHandler(byte);
+}
+
+void halSerialBegin(uint32_t baud, uint8_t format, void (*handler)(uint8_t byte)) {
+  UCSR1B = 0;
+  serialHandler = handler;
+
+  // Same double-speed baud rounding as HardwareSerial::begin()
+  UCSR1A = _BV(U2X1);
+  UBRR1 = (F_CPU / 4 / baud - 1) / 2;
+  if (format == HAL_SERIAL_8E2) {
+    UCSR1C = _BV(UPM11) | _BV(USBS1) | _BV(UCSZ11) | _BV(UCSZ10);
+  } else {
+    UCSR1C = _BV(UCSZ11) | _BV(UCSZ10);
+  }
+  UCSR1B = _BV(RXEN1) | _BV(RXCIE1);
+}
+
+uint32_t halSerialOverruns() {
+  uint8_t sreg = SREG;
+  cli();
+  uint32_t overruns = serialOverruns;
+  SREG = sreg;
+  return overruns;
+}
+
+void halAttachPPM(void (*handler)()) {
+  pinMode(PPM_PIN, INPUT);
+  attachInterrupt(digitalPinToInterrupt(PPM_PIN), handler, RISING);
+}
+
+// Timer1 counts at F_CPU/8 and copies its count into ICR1 on every rising
+// edge of PPM_CAPTURE_PIN
+ISR(TIMER1_CAPT_vect) {
+  uint16_t capture = ICR1;
+  // An overflow just before the edge may still be pending behind this vector
+  if ((TIFR1 & _BV(TOV1)) && capture < 0x8000) {
+    TIFR1 = _BV(TOV1);
+    if (captureOverflows < 2) captureOverflows++;
+  }
+  uint16_t ticks = capture - lastCapture;
+  if (captureOverflows > 1 || (captureOverflows == 1 && capture >= lastCapture)) {
+    ticks = HAL_CAPTURE_OVERFLOW;
+  }
+  lastCapture = capture;
+  captureOverflows = 0;
+  if (captureHandler) captureHandler(ticks);
+}
+
+ISR(TIMER1_OVF_vect) {
+  if (captureOverflows < 2) captureOverflows++;
+}
+
+void halAttachPPMCapture(void (*handler)(uint16_t ticks)) {
+  captureHandler = handler;
+  pinMode(PPM_CAPTURE_PIN, INPUT);
+  TCCR1A = 0;
+  TCCR1B = _BV(ICNC1) | _BV(ICES1) | _BV(CS11); // Noise canceler, rising edge, F_CPU/8
+  TIFR1 = _BV(ICF1) | _BV(TOV1);
+  TIMSK1 = _BV(ICIE1) | _BV(TOIE1);
+}
+
+void halInputEnd() {
+  UCSR1B = 0;
+  serialHandler = nullptr;
+  detachInterrupt(digitalPinToInterrupt(PPM_PIN));
+  TIMSK1 = 0;
+  captureHandler = nullptr;
+}
+
+void halNoInterrupts() {
+  noInterrupts();
+}
+
+void halInterrupts() {
+  interrupts();
+}
+
+// The tick shares Timer0 with millis(). The core runs it at F_CPU/64 and only
+// uses the overflow, so the compare match A interrupt fires once per 1.024ms
+// without touching the clock. OC0A (pin 11) is not used for PWM.
+ISR(TIMER0_COMPA_vect) {
+  if (tickHandler) tickHandler();
+}
+
+void halTickBegin(void (*handler)()) {
+  tickHandler = handler;
+  OCR0A = 0x80;
+  TIFR0 = _BV(OCF0A);
+  TIMSK0 |= _BV(OCIE0A);
+}
+
+// Timer3 counts CPU cycles for the profiler, the overflow interrupt extends
+// it to 32 bits. It fires every 4.1ms and costs well under 0.1% of the CPU.
+static volatile uint16_t cycleOverflows = 0;
+
+ISR(TIMER3_OVF_vect) {
+  cycleOverflows++;
+}
+
+void halCyclesBegin() {
+  TCCR3A = 0;
+  TCCR3B = _BV(CS30);                   // F_CPU/1
+  TCNT3 = 0;
+  TIFR3 = _BV(TOV3);
+  TIMSK3 = _BV(TOIE3);
+}
+
+uint32_t halCycles() {
+  uint8_t sreg = SREG;
+  cli();
+  uint16_t overflows = cycleOverflows;
+  uint16_t count = TCNT3;
+  // An overflow that is still pending behind cli() belongs to this count
+  if ((TIFR3 & _BV(TOV3)) && count < 0x8000) overflows++;
+  SREG = sreg;
+  return ((uint32_t)overflows << 16) | count;
+}
+
+void halStoreRead(uint16_t addr, void *data, uint16_t len) {
+  uint8_t *bytes = (uint8_t *)data;
+  for (uint16_t i = 0; i < len; i++) {
+    bytes[i] = EEPROM.read(addr + i);
+  }
+}
+
+void halStoreWrite(uint16_t addr, const void *data, uint16_t len) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  for (uint16_t i = 0; i < len; i++) {
+    EEPROM.update(addr + i, bytes[i]); // Only rewrites cells that changed
+  }
+}
+
+bool halHidBegin(uint16_t axisMask, uint8_t buttonCount, uint8_t hatCount) {
+  joystick = new Joystick_(JOYSTICK_DEFAULT_REPORT_ID,
+                          JOYSTICK_TYPE_JOYSTICK,
+                          buttonCount,                          // Only buttons that are assigned
+                          hatCount,                             // Only hat switches that are assigned
+                          axisMask & (1 << HID_AXIS_X),         // Include each axis only if mapped
+                          axisMask & (1 << HID_AXIS_Y),
+                          axisMask & (1 << HID_AXIS_Z),
+                          axisMask & (1 << HID_AXIS_RX),
+                          axisMask & (1 << HID_AXIS_RY),
+                          axisMask & (1 << HID_AXIS_RZ),
+                          axisMask & (1 << HID_AXIS_RUDDER),
+                          axisMask & (1 << HID_AXIS_THROTTLE),
+                          axisMask & (1 << HID_AXIS_ACCELERATOR),
+                          axisMask & (1 << HID_AXIS_BRAKE),
+                          axisMask & (1 << HID_AXIS_STEERING)
+                          );
+  if (!joystick) return false;
+
+  #ifdef DEBUG
+    Serial.println("Joystick object created.");
+    Serial.print("USB Status - USBCON: 0x"); Serial.println(USBCON, HEX);
+    Serial.print("UDCON: 0x"); Serial.println(UDCON, HEX);
+    Serial.flush();
+  #endif
+
+  // No auto send, every setter would otherwise send a report of its own.
+  // joystick_output.cpp sends once per changed state, after halHidReady().
+  joystick->begin(false);
+
+  // Only set ranges for axes that are actually mapped
+  if (axisMask & (1 << HID_AXIS_X)) joystick->setXAxisRange(0, HID_AXIS_MAX);
+  if (axisMask & (1 << HID_AXIS_Y)) joystick->setYAxisRange(0, HID_AXIS_MAX);
+  if (axisMask & (1 << HID_AXIS_Z)) joystick->setZAxisRange(0, HID_AXIS_MAX);
+  if (axisMask & (1 << HID_AXIS_RX)) joystick->setRxAxisRange(0, HID_AXIS_MAX);
+  if (axisMask & (1 << HID_AXIS_RY)) joystick->setRyAxisRange(0, HID_AXIS_MAX);
+  if (axisMask & (1 << HID_AXIS_RZ)) joystick->setRzAxisRange(0, HID_AXIS_MAX);
+  if (axisMask & (1 << HID_AXIS_RUDDER)) joystick->setRudderRange(0, HID_AXIS_MAX);
+  if (axisMask & (1 << HID_AXIS_THROTTLE)) joystick->setThrottleRange(0, HID_AXIS_MAX);
+  if (axisMask & (1 << HID_AXIS_ACCELERATOR)) joystick->setAcceleratorRange(0, HID_AXIS_MAX);
+  if (axisMask & (1 << HID_AXIS_BRAKE)) joystick->setBrakeRange(0, HID_AXIS_MAX);
+  if (axisMask & (1 << HID_AXIS_STEERING)) joystick->setSteeringRange(0, HID_AXIS_MAX);
+
+  return true;
+}
+
+void halHidSetAxis(uint8_t axis, uint16_t value) {
+  switch (axis) {
+    case HID_AXIS_X: joystick->setXAxis(value); break;
+    case HID_AXIS_Y: joystick->setYAxis(value); break;
+    case HID_AXIS_Z: joystick->setZAxis(value); break;
+    case HID_AXIS_RX: joystick->setRxAxis(value); break;
+    case HID_AXIS_RY: joystick->setRyAxis(value); break;
+    case HID_AXIS_RZ: joystick->setRzAxis(value); break;
+    case HID_AXIS_RUDDER: joystick->setRudder(value); break;
+    case HID_AXIS_THROTTLE: joystick->setThrottle(value); break;
+    case HID_AXIS_ACCELERATOR: joystick->setAccelerator(value); break;
+    case HID_AXIS_BRAKE: joystick->setBrake(value); break;
+    case HID_AXIS_STEERING: joystick->setSteering(value); break;
+  }
+}
+
+// Joystick_ keeps its button bytes private, so the word is applied through
+// setButton() for the bits that changed only
+void halHidSetButtons(uint32_t buttons) {
+  static uint32_t current = 0;
+  uint32_t changed = buttons ^ current;
+  for (uint8_t i = 0; changed; i++, changed >>= 1) {
+    if (changed & 1) joystick->setButton(i, (buttons >> i) & 1);
+  }
+  current = buttons;
+}
+
+void halHidSetHat(uint8_t hat, int16_t value) {
+  joystick->setHatSwitch(hat, value);
+}
+
+void halHidSendState() {
+  joystick->sendState();
+}
+
+bool halHidReady() {
+  return USBDevice.configured();
+}
+
+void halLedBegin() {
+  strip.begin();
+  strip.setBrightness(50);
+}
+
+void halLedShow(uint8_t r, uint8_t g, uint8_t b) {
+  strip.setPixelColor(0, strip.Color(r, g, b));
+  strip.show();
+}
+
+void halDebugPrint(const char *text) {
+  Serial.print(text);
+}
+
+void halDebugPrint(int32_t value) {
+  Serial.print(value);
+}
+
+void halDebugPrintln(const char *text) {
+  Serial.println(text);
+}
+
+void halDebugPrintln(int32_t value) {
+  Serial.println(value);
+}
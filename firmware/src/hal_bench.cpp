@@ -0,0 +1,357 @@
+// HAL for the simavr benchmark build ([env:bench])
+//
+// Bare-metal ATmega32U4 drivers without the Arduino core, so the firmware
+// runs under simavr without USB. Each driver mirrors the cost of the one it
+// stands in for on the dongle: the Timer0 clock works like the Arduino
+// millis()/micros(), USART1 hands bytes to the decoder from its RX interrupt
+// like hal_avr.cpp, the LED waits out the WS2812 latch and keeps interrupts off
+// for the 24 bit transfer like Adafruit_NeoPixel::show(), and the HID sink
+// copies the packed report into a stand-in endpoint buffer.
+//
+// main() brackets every receive interrupt, every readXxx() call after one and
+// the mapping with the markers from bench.h, then hands out the decoded
+// channels. Built with BENCH_LATENCY ([env:latency])
+// it runs the real joystick mode loop instead, and reports every change of
+// the protocol the input is receiving.
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/eeprom.h>
+#include <util/delay_basic.h>
+#include <stdlib.h>
+#include "hal.h"
+#include "bench.h"
+#include "config.h"
+#include "rc_input.h"
+#include "joystick_output.h"
+
+// Timer0 at F_CPU/64 overflows every 1024us at 16 MHz
+#define MICROS_PER_TIMER0_OVERFLOW (64UL * 256UL / (F_CPU / 1000000UL))
+#define MILLIS_INC (MICROS_PER_TIMER0_OVERFLOW / 1000)
+#define FRACT_INC ((MICROS_PER_TIMER0_OVERFLOW % 1000) >> 3)
+#define FRACT_MAX (1000 >> 3)
+
+static volatile uint32_t timer0Overflows = 0;
+static volatile uint32_t timer0Millis = 0;
+static uint8_t timer0Fract = 0;
+
+static void (*serialHandler)(uint8_t byte) = nullptr;
+static volatile uint32_t serialOverruns = 0;
+static void (*ppmHandler)() = nullptr;
+static void (*captureHandler)(uint16_t ticks) = nullptr;
+static uint16_t lastCapture = 0;
+static volatile uint8_t captureOverflows = 0;
+static volatile bool inputPending = false;
+static void (*tickHandler)() = nullptr;
+
+static uint16_t hidAxisMask = 0;
+static uint8_t hidHatCount = 0;
+static uint16_t hidAxes[HID_AXIS_COUNT];
+static uint32_t hidButtons = 0;
+static int16_t hidHats[2];
+static volatile uint8_t hidEndpoint[HID_AXIS_COUNT * 2 + 4 + 2]; // Stand-in for UEDATX
+
+#define WS2812_LATCH_US 300         // Adafruit_NeoPixel::canShow()
+#define WS2812_BIT_CYCLES 20        // 1.25us per bit at 16 MHz
+static uint32_t ledEndTime = 0;
+
+void *operator new(size_t size) {
+  return malloc(size);
+}
+
+ISR(TIMER0_OVF_vect) {
+  uint32_t m = timer0Millis + MILLIS_INC;
+  uint8_t f = timer0Fract + FRACT_INC;
+  if (f >= FRACT_MAX) {
+    f -= FRACT_MAX;
+    m += 1;
+  }
+  timer0Fract = f;
+  timer0Millis = m;
+  timer0Overflows++;
+}
+
+ISR(USART1_RX_vect) {
+  BENCH_MARK(BENCH_ISR_START);
+  uint8_t status = UCSR1A;
+  uint8_t byte = UDR1;
+  if (status & _BV(DOR1)) serialOverruns++;
+  if (!(status & _BV(UPE1)) && serialHandler) serialHandler(byte);
+  inputPending = true;
+  BENCH_MARK(BENCH_ISR_END);
+}
+
+ISR(INT2_vect) {
+  BENCH_MARK(BENCH_ISR_START);
+  if (ppmHandler) ppmHandler();
+  inputPending = true;
+  BENCH_MARK(BENCH_ISR_END);
+}
+
+// Same as hal_avr.cpp
+ISR(TIMER1_CAPT_vect) {
+  BENCH_MARK(BENCH_ISR_START);
+  uint16_t capture = ICR1;
+  if ((TIFR1 & _BV(TOV1)) && capture < 0x8000) {
+    TIFR1 = _BV(TOV1);
+    if (captureOverflows < 2) captureOverflows++;
+  }
+  uint16_t ticks = capture - lastCapture;
+  if (captureOverflows > 1 || (captureOverflows == 1 && capture >= lastCapture)) {
+    ticks = HAL_CAPTURE_OVERFLOW;
+  }
+  lastCapture = capture;
+  captureOverflows = 0;
+  if (captureHandler) captureHandler(ticks);
+  inputPending = true;
+  BENCH_MARK(BENCH_ISR_END);
+}
+
+ISR(TIMER1_OVF_vect) {
+  if (captureOverflows < 2) captureOverflows++;
+}
+
+uint32_t halMillis() {
+  uint8_t sreg = SREG;
+  cli();
+  uint32_t m = timer0Millis;
+  SREG = sreg;
+  return m;
+}
+
+uint32_t halMicros() {
+  uint8_t sreg = SREG;
+  cli();
+  uint32_t overflows = timer0Overflows;
+  uint8_t ticks = TCNT0;
+  if ((TIFR0 & _BV(TOV0)) && ticks < 255) overflows++;
+  SREG = sreg;
+  return ((overflows << 8) + ticks) * (64 / (F_CPU / 1000000UL));
+}
+
+void halSerialBegin(uint32_t baud, uint8_t format, void (*handler)(uint8_t byte)) {
+  UCSR1B = 0;
+  serialHandler = handler;
+
+  // Same double-speed baud rounding as the Arduino core
+  UCSR1A = _BV(U2X1);
+  UBRR1 = (F_CPU / 4 / baud - 1) / 2;
+  if (format == HAL_SERIAL_8E2) {
+    UCSR1C = _BV(UPM11) | _BV(USBS1) | _BV(UCSZ11) | _BV(UCSZ10);
+  } else {
+    UCSR1C = _BV(UCSZ11) | _BV(UCSZ10);
+  }
+  UCSR1B = _BV(RXEN1) | _BV(RXCIE1);
+}
+
+uint32_t halSerialOverruns() {
+  uint8_t sreg = SREG;
+  cli();
+  uint32_t overruns = serialOverruns;
+  SREG = sreg;
+  return overruns;
+}
+
+void halAttachPPM(void (*handler)()) {
+  ppmHandler = handler;
+  DDRD &= ~_BV(PD2);                    // Pin 0 (RX) is PD2 / INT2
+  EICRA |= _BV(ISC21) | _BV(ISC20);     // Rising edge
+  EIFR = _BV(INTF2);
+  EIMSK |= _BV(INT2);
+}
+
+void halAttachPPMCapture(void (*handler)(uint16_t ticks)) {
+  captureHandler = handler;
+  DDRD &= ~_BV(PD4);                    // Pin 4 is PD4 / ICP1
+  TCCR1A = 0;
+  TCCR1B = _BV(ICNC1) | _BV(ICES1) | _BV(CS11);
+  TIFR1 = _BV(ICF1) | _BV(TOV1);
+  TIMSK1 = _BV(ICIE1) | _BV(TOIE1);
+}
+
+void halInputEnd() {
+  UCSR1B = 0;
+  serialHandler = nullptr;
+  EIMSK &= ~_BV(INT2);
+  ppmHandler = nullptr;
+  TIMSK1 = 0;
+  captureHandler = nullptr;
+}
+
+void halNoInterrupts() {
+  cli();
+}
+
+void halInterrupts() {
+  sei();
+}
+
+// Same as hal_avr.cpp
+ISR(TIMER0_COMPA_vect) {
+  if (tickHandler) tickHandler();
+}
+
+void halTickBegin(void (*handler)()) {
+  tickHandler = handler;
+  OCR0A = 0x80;
+  TIFR0 = _BV(OCF0A);
+  TIMSK0 |= _BV(OCIE0A);
+}
+
+// Same as hal_avr.cpp
+static volatile uint16_t cycleOverflows = 0;
+
+ISR(TIMER3_OVF_vect) {
+  cycleOverflows++;
+}
+
+void halCyclesBegin() {
+  TCCR3A = 0;
+  TCCR3B = _BV(CS30);
+  TCNT3 = 0;
+  TIFR3 = _BV(TOV3);
+  TIMSK3 = _BV(TOIE3);
+}
+
+uint32_t halCycles() {
+  uint8_t sreg = SREG;
+  cli();
+  uint16_t overflows = cycleOverflows;
+  uint16_t count = TCNT3;
+  if ((TIFR3 & _BV(TOV3)) && count < 0x8000) overflows++;
+  SREG = sreg;
+  return ((uint32_t)overflows << 16) | count;
+}
+
+void halStoreRead(uint16_t addr, void *data, uint16_t len) {
+  eeprom_read_block(data, (const void *)addr, len);
+}
+
+void halStoreWrite(uint16_t addr, const void *data, uint16_t len) {
+  eeprom_update_block(data, (void *)addr, len);
+}
+
+bool halHidBegin(uint16_t axisMask, uint8_t buttonCount, uint8_t hatCount) {
+  hidAxisMask = axisMask;
+  hidHatCount = hatCount;
+  return true;
+}
+
+void halHidSetAxis(uint8_t axis, uint16_t value) {
+  if (axis < HID_AXIS_COUNT) hidAxes[axis] = value;
+}
+
+void halHidSetButtons(uint32_t buttons) {
+  hidButtons = buttons;
+}
+
+void halHidSetHat(uint8_t hat, int16_t value) {
+  if (hat < 2) hidHats[hat] = value;
+}
+
+void halHidSendState() {
+  // Pack the report the way Joystick_::sendState() does and copy it out with
+  // interrupts off like USB_Send()
+  uint8_t n = 0;
+  uint8_t sreg = SREG;
+  cli();
+  hidEndpoint[n++] = hidButtons;
+  hidEndpoint[n++] = hidButtons >> 8;
+  hidEndpoint[n++] = hidButtons >> 16;
+  hidEndpoint[n++] = hidButtons >> 24;
+  for (uint8_t i = 0; i < hidHatCount; i++) {
+    hidEndpoint[n++] = hidHats[i];
+  }
+  for (uint8_t i = 0; i < HID_AXIS_COUNT; i++) {
+    if (hidAxisMask & (1 << i)) {
+      hidEndpoint[n++] = hidAxes[i];
+      hidEndpoint[n++] = hidAxes[i] >> 8;
+    }
+  }
+  SREG = sreg;
+  BENCH_MARK(BENCH_HID_SENT);
+}
+
+bool halHidReady() {
+  return true;
+}
+
+void halLedBegin() {
+}
+
+void halLedShow(uint8_t r, uint8_t g, uint8_t b) {
+  BENCH_MARK(BENCH_LED_START);
+  // Wait for the previous update to latch, then clock out 24 bits
+  while (halMicros() - ledEndTime < WS2812_LATCH_US);
+  uint8_t sreg = SREG;
+  cli();
+  _delay_loop_2(24 * WS2812_BIT_CYCLES / 4);
+  SREG = sreg;
+  ledEndTime = halMicros();
+  BENCH_MARK(BENCH_LED_END);
+}
+
+void halDebugPrint(const char *text) {
+}
+
+void halDebugPrint(int32_t value) {
+}
+
+void halDebugPrintln(const char *text) {
+}
+
+void halDebugPrintln(int32_t value) {
+}
+
+int main() {
+  // Timer0 free running at F_CPU/64 for halMillis()/halMicros()
+  TCCR0A = 0;
+  TCCR0B = _BV(CS01) | _BV(CS00);
+  TIMSK0 = _BV(TOIE0);
+  sei();
+
+  // The harness preloads EEPROM with the configuration to benchmark
+  if (!loadConfigFromEEPROM()) {
+    generateDefaultConfig();
+  }
+  beginJoystick();
+
+  beginRcInput();
+
+  BENCH_MARK(BENCH_READY);
+
+#ifdef BENCH_LATENCY
+  uint8_t protocol = rcInputProtocol();
+  for (;;) {
+    joystickModeLoop();
+
+    // Protocol detection locking on or letting go, for bench/simdetect.cpp
+    if (rcInputProtocol() != protocol) {
+      protocol = rcInputProtocol();
+      GPIOR1 = protocol;
+      BENCH_MARK(BENCH_PROTOCOL);
+    }
+  }
+#else
+  for (;;) {
+    // Only time calls after an interrupt delivered input
+    if (!inputPending) continue;
+    inputPending = false;
+
+    BENCH_MARK(BENCH_DECODE_START);
+    bool frame = readProtocol();
+    BENCH_MARK(frame ? BENCH_FRAME_END : BENCH_DECODE_END);
+
+    if (frame) {
+      BENCH_MARK(BENCH_MAP_START);
+      updateJoystickFromChannels();
+      BENCH_MARK(BENCH_MAP_END);
+
+      for (uint8_t i = 0; i < 16; i++) {
+        GPIOR1 = channelData[i];
+        GPIOR2 = channelData[i] >> 8;
+        BENCH_MARK(BENCH_CHANNEL);
+      }
+    }
+  }
+#endif
+}
@@ -0,0 +1,306 @@
+// HAL stub drivers for the host build ([env:native])
+//
+// The clock only moves when the replay advances it, the UART hands each byte
+// straight to the decoder like the receive interrupt does, EEPROM is a RAM
+// array and the HID sink prints every report it is sent. The main() below
+// replays a capture through the same decode/mapping core that runs on the
+// Pro Micro:
+//
+//   .pio/build/native/program <protocol> < capture.bin
+//
+// For ppm and ppm_icp the input is a whitespace separated list of edge
+// intervals in us.
+//
+// The unit tests under test/ (pio test -e native) drive the same stubs
+// through hal_native.h and bring their own main().
+
+#include <stdio.h>
+#include <string.h>
+#include "hal.h"
+#include "hal_native.h"
+#include "config.h"
+#include "rc_input.h"
+#include "joystick_output.h"
+
+static uint32_t nowMicros = 0;
+
+static void (*serialHandler)(uint8_t byte) = nullptr;
+static uint32_t byteMicros = 87; // Time on the wire per byte, set by halSerialBegin()
+static uint32_t serialBaud = 0;
+static uint8_t serialFormat = HAL_SERIAL_8N1;
+
+static void (*ppmHandler)() = nullptr;
+static void (*captureHandler)(uint16_t ticks) = nullptr;
+static void (*tickHandler)() = nullptr;
+
+static uint8_t store[NATIVE_STORE_SIZE];
+static uint32_t storeWrites[NATIVE_STORE_SIZE]; // Per cell, counted like EEPROM.update() writes
+
+static uint16_t hidAxes[HID_AXIS_COUNT];
+static uint16_t hidAxisMask = 0;
+static uint32_t hidButtons = 0;
+static uint8_t hidButtonCount = 0;
+static int16_t hidHats[2] = {-1, -1};
+static uint8_t hidHatCount = 0;
+static uint32_t reportsSent = 0;
+
+static uint32_t ledShows = 0;
+
+uint32_t halMillis() {
+  return nowMicros / 1000;
+}
+
+uint32_t halMicros() {
+  return nowMicros;
+}
+
+void halSerialBegin(uint32_t baud, uint8_t format, void (*handler)(uint8_t byte)) {
+  uint32_t bitsPerByte = (format == HAL_SERIAL_8E2) ? 12 : 10;
+  byteMicros = (bitsPerByte * 1000000UL + baud - 1) / baud;
+  serialBaud = baud;
+  serialFormat = format;
+  serialHandler = handler;
+}
+
+// Replayed bytes are never lost
+uint32_t halSerialOverruns() {
+  return 0;
+}
+
+void halAttachPPM(void (*handler)()) {
+  ppmHandler = handler;
+}
+
+void halAttachPPMCapture(void (*handler)(uint16_t ticks)) {
+  captureHandler = handler;
+}
+
+void halInputEnd() {
+  serialHandler = nullptr;
+  ppmHandler = nullptr;
+  captureHandler = nullptr;
+}
+
+void halNoInterrupts() {
+}
+
+void halInterrupts() {
+}
+
+// The replay calls it after every step
+void halTickBegin(void (*handler)()) {
+  tickHandler = handler;
+}
+
+void halCyclesBegin() {
+}
+
+// The replay clock at 16 MHz
+uint32_t halCycles() {
+  return nowMicros * 16;
+}
+
+void halStoreRead(uint16_t addr, void *data, uint16_t len) {
+  memcpy(data, &store[addr], len);
+}
+
+void halStoreWrite(uint16_t addr, const void *data, uint16_t len) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  for (uint16_t i = 0; i < len; i++) {
+    if (store[addr + i] != bytes[i]) storeWrites[addr + i]++;
+    store[addr + i] = bytes[i];
+  }
+}
+
+bool halHidBegin(uint16_t axisMask, uint8_t buttonCount, uint8_t hatCount) {
+  hidAxisMask = axisMask;
+  hidButtonCount = buttonCount;
+  hidHatCount = hatCount;
+  return true;
+}
+
+void halHidSetAxis(uint8_t axis, uint16_t value) {
+  if (axis < HID_AXIS_COUNT) hidAxes[axis] = value;
+}
+
+void halHidSetButtons(uint32_t buttons) {
+  hidButtons = buttons;
+}
+
+void halHidSetHat(uint8_t hat, int16_t value) {
+  if (hat < 2) hidHats[hat] = value;
+}
+
+void halHidSendState() {
+  reportsSent++;
+  printf("%lu us report %lu axes", (unsigned long)nowMicros, (unsigned long)reportsSent);
+  for (int i = 0; i < HID_AXIS_COUNT; i++) {
+    if (hidAxisMask & (1 << i)) printf(" %u", hidAxes[i]);
+  }
+  printf(" buttons 0x%08lx", (unsigned long)(hidButtons & ((hidButtonCount >= 32) ? 0xFFFFFFFFUL : ((1UL << hidButtonCount) - 1))));
+  for (int i = 0; i < hidHatCount; i++) {
+    printf(" hat%d %d", i + 1, hidHats[i]);
+  }
+  printf("\n");
+}
+
+bool halHidReady() {
+  return true;
+}
+
+void halLedBegin() {
+}
+
+// Only counted, the colour is not part of the replay output
+void halLedShow(uint8_t, uint8_t, uint8_t) {
+  ledShows++;
+}
+
+void halDebugPrint(const char *text) {
+  fputs(text, stderr);
+}
+
+void halDebugPrint(int32_t value) {
+  fprintf(stderr, "%ld", (long)value);
+}
+
+void halDebugPrintln(const char *text) {
+  fprintf(stderr, "%s\n", text);
+}
+
+void halDebugPrintln(int32_t value) {
+  fprintf(stderr, "%ld\n", (long)value);
+}
+
+// --- Driven by the replay and the unit tests, see hal_native.h ---
+
+void nativeSetMicros(uint32_t micros) {
+  nowMicros = micros;
+}
+
+void nativeAdvanceMicros(uint32_t micros) {
+  nowMicros += micros;
+}
+
+void nativeSerialByte(uint8_t byte) {
+  if (serialHandler) serialHandler(byte);
+}
+
+void nativePPMEdge() {
+  if (ppmHandler) ppmHandler();
+}
+
+void nativeCaptureEdge(uint32_t ticks) {
+  if (captureHandler) captureHandler(ticks > HAL_CAPTURE_OVERFLOW ? HAL_CAPTURE_OVERFLOW : ticks);
+}
+
+void nativeTick() {
+  if (tickHandler) tickHandler();
+}
+
+bool nativeSerialRunning() {
+  return serialHandler != nullptr;
+}
+
+uint32_t nativeSerialBaud() {
+  return serialBaud;
+}
+
+uint8_t nativeSerialFormat() {
+  return serialFormat;
+}
+
+uint32_t nativeSerialByteMicros() {
+  return byteMicros;
+}
+
+uint8_t *nativeStore() {
+  return store;
+}
+
+uint32_t nativeStoreWrites(uint16_t addr) {
+  return storeWrites[addr];
+}
+
+void nativeStoreErase() {
+  memset(store, 0xFF, sizeof(store));
+  memset(storeWrites, 0, sizeof(storeWrites));
+}
+
+uint32_t nativeLedShows() {
+  return ledShows;
+}
+
+#ifndef PIO_UNIT_TESTING
+static bool parseProtocol(const char *name, uint8_t *protocol) {
+  static const struct { const char *name; uint8_t id; } protocols[] = {
+    {"ibus", IBUS}, {"sbus", SBUS}, {"crsf", CRSF}, {"dsmx", DSMX},
+    {"dsm2", DSM2}, {"fport", FPORT}, {"ppm", PPM}, {"ppm_icp", PPM_CAPTURE},
+  };
+  for (unsigned i = 0; i < sizeof(protocols) / sizeof(protocols[0]); i++) {
+    if (strcmp(name, protocols[i].name) == 0) {
+      *protocol = protocols[i].id;
+      return true;
+    }
+  }
+  return false;
+}
+
+int main(int argc, char **argv) {
+  uint8_t protocol;
+  if (argc < 2 || !parseProtocol(argv[1], &protocol)) {
+    fprintf(stderr, "usage: %s <ibus|sbus|crsf|dsmx|dsm2|fport|ppm|ppm_icp> < capture\n", argv[0]);
+    return 2;
+  }
+
+  nativeStoreErase();
+  if (!loadConfigFromEEPROM()) {
+    generateDefaultConfig();
+  }
+  config.protocol = protocol;
+  beginJoystick();
+
+  uint32_t frames = 0;
+  beginRcInput();
+
+  if (protocol == PPM || protocol == PPM_CAPTURE) {
+    unsigned long interval;
+    while (scanf("%lu", &interval) == 1) {
+      nowMicros += interval;
+      nativeTick();
+      serviceFailsafe();
+      nativePPMEdge();
+      nativeCaptureEdge(interval * HAL_CAPTURE_TICKS_PER_US);
+      if (readProtocol()) {
+        updateJoystickFromChannels();
+        frames++;
+      }
+    }
+  } else {
+    int c;
+    while ((c = getchar()) != EOF) {
+      nowMicros += byteMicros;
+      nativeTick();
+      serviceFailsafe();
+      nativeSerialByte((uint8_t)c); // The receive interrupt
+      if (readProtocol()) {
+        updateJoystickFromChannels();
+        frames++;
+      }
+    }
+  }
+
+  ReportStats reports = getReportStats();
+  fprintf(stderr, "%lu frames decoded, %lu reports sent, %lu replaced, %lu unchanged, %lu keep-alive, %lu LED updates\n",
+          (unsigned long)frames, (unsigned long)reports.sent, (unsigned long)reports.replaced,
+          (unsigned long)reports.unchanged,
+          (unsigned long)reports.keepAlive, (unsigned long)ledShows);
+
+  RcLinkStats link;
+  readRcLinkStats(&link);
+  fprintf(stderr, "link: %lu ok, %lu bad, %lu resyncs, %lu byte timeouts, %lu lost, %lu failsafe\n",
+          (unsigned long)link.frames, (unsigned long)link.errors, (unsigned long)link.resyncs,
+          (unsigned long)link.byteTimeouts, (unsigned long)link.lostFrames, (unsigned long)link.failsafeFrames);
+  return 0;
+}
+#endif // PIO_UNIT_TESTING
@@ -0,0 +1,313 @@
+#include <string.h>
+#include "joystick_output.h"
+#include "config.h"
+#include "rc_input.h"
+#include "hal.h"
+#include "status_led.h"
+#include "boot_timing.h"
+#include "profiler.h"
+
+#define LED_DATA_PULSE_MS 50 // Bright green after a frame, outlasts the LED rate limit
+
+// Shadow of the HID report, so unchanged reports are not sent again
+struct HidReport {
+  uint16_t axes[HID_AXIS_COUNT];
+  uint32_t buttons;             // Bit n = button n + 1
+  int16_t hats[2];
+};
+
+static HidReport report;        // Built from the latest frame
+static HidReport sentReport;    // Last report handed to the HID sink
+static bool reportPending = false;
+static uint32_t lastReportTime = 0;
+static ReportStats stats = {0, 0, 0, 0};
+
+// JoystickConfig compiled into one op per mapped axis or hat, so a frame only
+// touches the controls that are in use
+enum MapOpKind {
+  MAP_AXIS,
+  MAP_HAT
+};
+
+struct MapOp {
+  uint8_t channel;              // Index into channelData
+  uint8_t kind;                 // MapOpKind
+  uint8_t target;               // HidAxis or hat index
+};
+
+static MapOp mapProgram[HID_AXIS_COUNT + 2];
+static uint8_t mapOpCount = 0;
+
+// Buttons are grouped by source channel. Each channel's threshold is checked
+// once per frame and sets all the buttons it drives in one OR.
+struct ButtonGroup {
+  uint8_t channel;              // Index into channelData
+  uint32_t buttons;             // Bit n = button n + 1
+};
+
+static ButtonGroup buttonGroups[16];
+static uint8_t buttonGroupCount = 0;
+
+// Failsafe. The watchdog runs off the HAL tick, so the loss of signal is
+// noticed on time even while the loop is held up. serviceFailsafe() then
+// applies the actions on the loop's next pass, where the report is built.
+static_assert(FAILSAFE_AXES == HID_AXIS_COUNT, "One failsafe value per axis");
+
+static volatile bool signalLost = false;
+static bool failsafeOn = false;
+
+// Interrupt context. Reads rcLink directly, rcFrameAge() would turn
+// interrupts back on.
+static void failsafeTick() {
+  uint16_t timeout = settings.failsafeTimeout;
+  signalLost = timeout && (rcLink.receiverFailsafe || halMillis() - rcLink.lastFrameTime > timeout);
+}
+
+static void addMapOp(uint8_t channel, uint8_t kind, uint8_t target) {
+  // Channels outside 1-16 are treated as unmapped, like before
+  if (channel == 0 || channel > 16) return;
+  mapProgram[mapOpCount].channel = channel - 1;
+  mapProgram[mapOpCount].kind = kind;
+  mapProgram[mapOpCount].target = target;
+  mapOpCount++;
+}
+
+// Rebuild the mapping program from config
+void compileMapping() {
+  mapOpCount = 0;
+
+  // Axis fields are laid out in HidAxis order right after the protocol byte
+  const uint8_t *axes = &config.x_axis;
+  for (uint8_t i = 0; i < HID_AXIS_COUNT; i++) {
+    addMapOp(axes[i], MAP_AXIS, i);
+  }
+  addMapOp(config.hat_switch1, MAP_HAT, 0);
+  addMapOp(config.hat_switch2, MAP_HAT, 1);
+
+  uint32_t channelButtons[16] = {0};
+  for (uint8_t i = 0; i < 32; i++) {
+    uint8_t channel = config.buttons[i];
+    if (channel > 0 && channel <= 16) channelButtons[channel - 1] |= (1UL << i);
+  }
+  buttonGroupCount = 0;
+  for (uint8_t i = 0; i < 16; i++) {
+    if (!channelButtons[i]) continue;
+    buttonGroups[buttonGroupCount].channel = i;
+    buttonGroups[buttonGroupCount].buttons = channelButtons[i];
+    buttonGroupCount++;
+  }
+
+  #ifdef DEBUG
+    halDebugPrint("Mapping ops: "); halDebugPrint(mapOpCount);
+    halDebugPrint(", Button channels: "); halDebugPrintln(buttonGroupCount);
+  #endif
+}
+
+// Create the HID device with only the controls that are mapped
+bool beginJoystick() {
+  // Axis fields are laid out in HidAxis order right after the protocol byte
+  const uint8_t *axes = &config.x_axis;
+  uint16_t axisMask = 0;
+  for (int i = 0; i < HID_AXIS_COUNT; i++) {
+    if (axes[i] > 0) axisMask |= (1 << i);
+  }
+
+  // Count assigned buttons
+  uint8_t buttonCount = 0;
+  for (int i = 0; i < 32; i++) {
+    if (config.buttons[i] > 0) {
+      buttonCount = i + 1;
+    }
+  }
+  if (settings.failsafeLostButton > buttonCount) buttonCount = settings.failsafeLostButton;
+
+  // Count assigned hat switches
+  uint8_t hatCount = 0;
+  if (config.hat_switch2 > 0) hatCount = 2;
+  else if (config.hat_switch1 > 0) hatCount = 1;
+
+  #ifdef DEBUG
+    halDebugPrint("Buttons: "); halDebugPrint(buttonCount);
+    halDebugPrint(", Hats: "); halDebugPrint(hatCount);
+    halDebugPrint(", Axis mask: "); halDebugPrintln(axisMask);
+  #endif
+
+  compileMapping();
+
+  // The host starts out with a centred hat and everything else at zero
+  memset(&report, 0, sizeof(report));
+  report.hats[0] = report.hats[1] = -1;
+  sentReport = report;
+
+  signalLost = false;
+  failsafeOn = false;
+  halTickBegin(failsafeTick);
+
+  return halHidBegin(axisMask, buttonCount, hatCount);
+}
+
+// One pass of loop() in joystick mode
+void joystickModeLoop() {
+  PROFILE_START(ledStart);
+  updateLED(); // Update non-blocking LED effects
+  PROFILE_END(ledStart, PROFILE_LED);
+  serviceFailsafe();
+  serviceHidReport(); // Held back or keep-alive reports
+
+  // Quick green pulse for data received. setLED() only pushes changes, so
+  // the pulse is held for LED_DATA_PULSE_MS instead of a single loop pass.
+  static uint32_t lastFlash = 0;
+  PROFILE_START(decodeStart);
+  bool frame = readProtocol();
+  PROFILE_END(decodeStart, frame ? PROFILE_DECODE : PROFILE_POLL);
+  if (frame) {
+    markBootPhase(BOOT_FIRST_FRAME);
+    updateJoystickFromChannels();
+    if (halMillis() - lastFlash > 500) {
+      lastFlash = halMillis();
+    }
+  }
+  if (halMillis() - lastFlash < LED_DATA_PULSE_MS) {
+    setLED(0, 255, 0); // Bright green for data
+  } else {
+    // No data - dim green
+    setLED(0, 64, 0); // Dim green for no data
+  }
+}
+
+void updateJoystickFromChannels() {
+  PROFILE_START(mapStart);
+  for (uint8_t i = 0; i < mapOpCount; i++) {
+    const MapOp &op = mapProgram[i];
+    uint16_t value = channelData[op.channel];
+    switch (op.kind) {
+      case MAP_AXIS:
+        report.axes[op.target] = mapChannelToAxis(value);
+        break;
+      case MAP_HAT:
+        report.hats[op.target] = mapChannelToHat(value);
+        break;
+    }
+  }
+
+  // Unmapped buttons stay released, so the word is rebuilt from scratch
+  uint32_t buttons = 0;
+  for (uint8_t i = 0; i < buttonGroupCount; i++) {
+    if (mapChannelToButton(channelData[buttonGroups[i].channel])) buttons |= buttonGroups[i].buttons;
+  }
+  report.buttons = buttons;
+
+  // A change still held back by the minimum interval is replaced by this one
+  if (reportPending) stats.replaced++;
+  reportPending = memcmp(&report, &sentReport, sizeof(report)) != 0;
+  if (!reportPending) stats.unchanged++;
+  PROFILE_END(mapStart, PROFILE_MAP);
+
+  serviceHidReport();
+}
+
+// Every mapped control that does not hold goes to its failsafe value, and
+// the signal lost button is pressed. The first frame after the signal
+// returns rebuilds the report from the channels.
+static void applyFailsafe() {
+  const uint8_t *axes = &config.x_axis;
+  for (uint8_t i = 0; i < HID_AXIS_COUNT; i++) {
+    if (axes[i] && settings.failsafeAxes[i]) report.axes[i] = mapChannelToAxis(settings.failsafeAxes[i]);
+  }
+  const uint8_t *hats = &config.hat_switch1;
+  for (uint8_t i = 0; i < 2; i++) {
+    if (hats[i] && settings.failsafeHats[i] == FAILSAFE_RELEASE) report.hats[i] = -1;
+  }
+  for (uint8_t i = 0; i < 32; i++) {
+    if (!config.buttons[i]) continue;
+    uint8_t action = (settings.failsafeButtons[i / 4] >> ((i & 3) * 2)) & 3;
+    if (action == FAILSAFE_RELEASE) report.buttons &= ~(1UL << i);
+    else if (action == FAILSAFE_PRESS) report.buttons |= 1UL << i;
+  }
+  if (settings.failsafeLostButton) report.buttons |= 1UL << (settings.failsafeLostButton - 1);
+
+  reportPending = memcmp(&report, &sentReport, sizeof(report)) != 0;
+}
+
+void serviceFailsafe() {
+  bool lost = signalLost;
+  if (lost == failsafeOn) return;
+  failsafeOn = lost;
+  if (lost) applyFailsafe();
+
+  #ifdef DEBUG
+    halDebugPrintln(lost ? "Failsafe: signal lost" : "Failsafe: signal back");
+  #endif
+}
+
+bool failsafeActive() {
+  return failsafeOn;
+}
+
+// Hand the report to the HID sink, only touching the fields that changed
+static void sendReport() {
+  for (uint8_t i = 0; i < HID_AXIS_COUNT; i++) {
+    if (report.axes[i] != sentReport.axes[i]) halHidSetAxis(i, report.axes[i]);
+  }
+  if (report.buttons != sentReport.buttons) halHidSetButtons(report.buttons);
+  for (uint8_t i = 0; i < 2; i++) {
+    if (report.hats[i] != sentReport.hats[i]) halHidSetHat(i, report.hats[i]);
+  }
+
+  PROFILE_START(sendStart);
+  halHidSendState();
+  PROFILE_END(sendStart, PROFILE_SEND);
+  markBootPhase(BOOT_FIRST_REPORT);
+  sentReport = report;
+  lastReportTime = halMillis();
+}
+
+// Send a changed report once the minimum interval allows it, and repeat an
+// unchanged one when the keep-alive interval runs out
+void serviceHidReport() {
+  // Until the host has configured the device a change is held, and goes out
+  // the moment enumeration completes
+  if (!halHidReady()) return;
+  markBootPhase(BOOT_USB_CONFIGURED);
+
+  uint32_t elapsed = halMillis() - lastReportTime;
+
+  if (reportPending) {
+    if (elapsed < settings.reportMinInterval) return;
+    reportPending = false;
+    sendReport();
+    stats.sent++;
+  } else if (settings.reportKeepAlive > 0 && elapsed >= settings.reportKeepAlive) {
+    sendReport();
+    stats.keepAlive++;
+  }
+}
+
+ReportStats getReportStats() {
+  return stats;
+}
+
+uint16_t mapChannelToAxis(uint16_t channelValue) {
+  // Map 1000-2000 to 0-1023
+  if (channelValue < 1000) channelValue = 1000;
+  if (channelValue > 2000) channelValue = 2000;
+
+  return rcScale(channelValue - 1000, RC_SCALE_AXIS_MUL, RC_SCALE_AXIS_SHIFT);
+}
+
+bool mapChannelToButton(uint16_t channelValue) {
+  // Channel value > 1500 = button pressed
+  return channelValue > 1500;
+}
+
+int mapChannelToHat(uint16_t channelValue) {
+  // Map channel value to 8-position hat switch
+  if (channelValue < 1000) channelValue = 1000;
+  if (channelValue > 2000) channelValue = 2000;
+
+  // Map to 8 positions (0-7) or -1 for center
+  int position = rcScale(channelValue - 1000, RC_SCALE_HAT_MUL, RC_SCALE_HAT_SHIFT);
+  if (position >= 8) position = -1; // Center position
+
+  return position;
+}
@@ -0,0 +1,23 @@
+#include "monitor.h"
+#include "rc_input.h"
+
+static uint8_t monitorSequence = 0;
+
+uint8_t buildMonitorFrame(uint8_t *out) {
+  RcLinkStats link;
+  readRcLinkStats(&link);
+
+  uint8_t payload[MONITOR_PAYLOAD_SIZE];
+  uint8_t n = 0;
+  payload[n++] = SERIAL_FRAME_MONITOR;
+  payload[n++] = monitorSequence++;
+  payload[n++] = link.frames;
+  payload[n++] = link.frames >> 8;
+  payload[n++] = link.errors;
+  payload[n++] = link.errors >> 8;
+  for (uint8_t i = 0; i < 16; i++) {
+    payload[n++] = channelData[i];
+    payload[n++] = channelData[i] >> 8;
+  }
+  return encodeSerialFrame(payload, n, out);
+}
@@ -0,0 +1,131 @@
+#include "profiler.h"
+
+#ifdef PROFILE
+
+struct StageTotals {
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t total;               // 32 bits would overflow after 268s of a stage that never stops
+};
+
+static StageTotals stages[PROFILE_STAGE_COUNT];
+static uint32_t buckets[PROFILE_BUCKETS];
+static uint32_t lastLoop = 0;
+static bool loopStarted = false;
+static uint16_t overhead = 0;
+static uint16_t floorCycles = 0;
+static uint16_t loopOverhead = 0;
+
+static const char nameLoop[] PROGMEM = "loop";
+static const char namePoll[] PROGMEM = "poll";
+static const char nameDecode[] PROGMEM = "decode";
+static const char nameMap[] PROGMEM = "map";
+static const char nameSend[] PROGMEM = "send";
+static const char nameLed[] PROGMEM = "led";
+
+static const char *const stageNames[PROFILE_STAGE_COUNT] PROGMEM = {
+  nameLoop, namePoll, nameDecode, nameMap, nameSend, nameLed
+};
+
+void profileRecord(uint8_t stage, uint32_t cycles) {
+  StageTotals &totals = stages[stage];
+  if (cycles < totals.min) totals.min = cycles;
+  if (cycles > totals.max) totals.max = cycles;
+  totals.total += cycles;
+  totals.count++;
+}
+
+void profileReset() {
+  for (uint8_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+    stages[i].count = 0;
+    stages[i].min = 0xFFFFFFFF;
+    stages[i].max = 0;
+    stages[i].total = 0;
+  }
+  for (uint8_t i = 0; i < PROFILE_BUCKETS; i++) {
+    buckets[i] = 0;
+  }
+  loopStarted = false; // The pass that called this is not a normal one
+}
+
+void profileBegin() {
+  halCyclesBegin();
+
+  // Smallest of a few tries, so an interrupt in between does not count.
+  // Empty: two reads back to back. Bracket: the same two reads with a
+  // whole bracket between them.
+  // profileLoop() is timed the same way, once a first call has started
+  // the period, so every try runs the recording path.
+  uint32_t empty = 0xFFFFFFFF;
+  uint32_t bracket = 0xFFFFFFFF;
+  uint32_t loop = 0xFFFFFFFF;
+  profileLoop();
+  for (uint8_t i = 0; i < 16; i++) {
+    uint32_t before = halCycles();
+    uint32_t after = halCycles();
+    if (after - before < empty) empty = after - before;
+
+    before = halCycles();
+    PROFILE_START(start);
+    PROFILE_END(start, PROFILE_LOOP);
+    after = halCycles();
+    if (after - before < bracket) bracket = after - before;
+
+    before = halCycles();
+    profileLoop();
+    after = halCycles();
+    if (after - before < loop) loop = after - before;
+  }
+  floorCycles = empty;
+  overhead = bracket - empty;
+  loopOverhead = loop - empty;
+
+  profileReset();
+}
+
+void profileLoop() {
+  uint32_t now = halCycles();
+  if (loopStarted) {
+    uint32_t period = now - lastLoop;
+    profileRecord(PROFILE_LOOP, period);
+
+    uint8_t bucket = 0;
+    for (period >>= PROFILE_BUCKET_SHIFT; period && bucket < PROFILE_BUCKETS - 1; period >>= 1) {
+      bucket++;
+    }
+    buckets[bucket]++;
+  }
+  lastLoop = now;
+  loopStarted = true;
+}
+
+void readProfileStats(uint8_t stage, ProfileStats *stats) {
+  const StageTotals &totals = stages[stage];
+  stats->count = totals.count;
+  stats->min = totals.count ? totals.min : 0;
+  stats->max = totals.max;
+  stats->mean = totals.count ? totals.total / totals.count : 0;
+}
+
+uint32_t profileBucket(uint8_t bucket) {
+  return buckets[bucket];
+}
+
+uint16_t profileOverhead() {
+  return overhead;
+}
+
+uint16_t profileFloor() {
+  return floorCycles;
+}
+
+uint16_t profileLoopOverhead() {
+  return loopOverhead;
+}
+
+const char *profileStageName(uint8_t stage) {
+  return (const char *)pgm_read_ptr(&stageNames[stage]);
+}
+
+#endif // PROFILE
@@ -0,0 +1,910 @@
+#include "rc_input.h"
+#include "rc_decoder.h"
+#include "config.h"
+#include "hal.h"
+#include "channel_filter.h"
+#include "channel_conditioning.h"
+
+uint16_t channelData[16] = {1500}; // RC channel data (1000-2000)
+
+RxFrames rcRx;
+volatile RcLinkStats rcLink;
+
+// Copy out the published frame with interrupts off, so the receive interrupt
+// cannot swap buffers halfway through
+bool rxTake(uint8_t *frame) {
+  if (!rcRx.ready) return false;
+
+  halNoInterrupts();
+  const uint8_t *front = rcRx.buffer[rcRx.back ^ 1];
+  for (uint8_t i = 0; i < rcRx.length; i++) {
+    frame[i] = front[i];
+  }
+  rcRx.ready = false;
+  halInterrupts();
+  return true;
+}
+
+uint32_t rcFrameAge() {
+  halNoInterrupts();
+  uint32_t lastFrameTime = rcLink.lastFrameTime;
+  halInterrupts();
+  return halMillis() - lastFrameTime;
+}
+
+void rcLinkFrame() {
+  uint32_t now = halMicros();
+  if (rcLink.frames) {
+    uint32_t interval = now - rcLink.lastFrameMicros;
+    uint16_t us = (interval > 0xFFFF) ? 0xFFFF : interval;
+    if (us < rcLink.intervalMin || rcLink.intervalCount == 0) rcLink.intervalMin = us;
+    if (us > rcLink.intervalMax) rcLink.intervalMax = us;
+    // Halving both keeps the mean and leaves the total below 2^32
+    if (rcLink.intervalCount == 0xFFFF) {
+      rcLink.intervalTotal >>= 1;
+      rcLink.intervalCount >>= 1;
+    }
+    rcLink.intervalTotal += us;
+    rcLink.intervalCount++;
+  }
+  rcLink.lastFrameMicros = now;
+  rcLink.lastFrameTime = halMillis();
+  rcLink.frames++;
+}
+
+void readRcLinkStats(RcLinkStats *stats) {
+  halNoInterrupts();
+  memcpy(stats, (const void *)&rcLink, sizeof(RcLinkStats));
+  halInterrupts();
+  stats->overruns += halSerialOverruns();
+}
+
+void resetRcLinkIntervals() {
+  halNoInterrupts();
+  rcLink.intervalMax = 0;
+  rcLink.intervalTotal = 0;
+  rcLink.intervalCount = 0;
+  halInterrupts();
+}
+
+#ifdef DEBUG
+static void printChannels(const char *name) {
+  static uint32_t lastDebugTime = 0;
+  uint32_t currentTime = halMillis();
+  if (currentTime - lastDebugTime > 1000) { // Debug every second
+    halDebugPrint(name);
+    halDebugPrint(" Channels: ");
+    for (int i = 0; i < 3; i++) {
+      halDebugPrint(channelData[i]);
+      halDebugPrint(" ");
+    }
+    halDebugPrintln();
+    lastDebugTime = currentTime;
+  }
+}
+#endif
+
+// Unpack 16 channels from 22 bytes (11-bit channels) and convert the
+// SBUS/CRSF/FPORT range (172-1811) to standard RC range (1000-2000)
+static void unpack11(const uint8_t *payload, uint8_t length) {
+  uint16_t channels[16];
+  uint32_t bitBuffer = 0;
+  uint8_t bitCount = 0;
+  uint8_t channelIndex = 0;
+
+  for (int i = 0; i < length && channelIndex < 16; i++) {
+    bitBuffer |= ((uint32_t)payload[i]) << bitCount;
+    bitCount += 8;
+
+    while (bitCount >= 11 && channelIndex < 16) {
+      channels[channelIndex] = bitBuffer & 0x7FF; // Extract 11 bits
+      bitBuffer >>= 11;
+      bitCount -= 11;
+      channelIndex++;
+    }
+  }
+
+  for (int i = 0; i < 16; i++) {
+    if (channels[i] < 172) channels[i] = 172;
+    if (channels[i] > 1811) channels[i] = 1811;
+    channelData[i] = 1000 + rcScale(channels[i] - 172, RC_SCALE_11BIT_MUL, RC_SCALE_11BIT_SHIFT);
+  }
+}
+
+// IBUS protocol implementation
+// IBUS frame format: 0x20 (length) + 0x40 (command) + 14 channels (uint16 LE) + checksum (uint16 LE)
+// Checksum is 0xFFFF minus the sum of all preceding bytes
+struct IBusProtocol {
+  static const uint32_t BAUD = 115200;
+  static const uint8_t FORMAT = HAL_SERIAL_8N1;
+  static const uint8_t BYTE_TIMEOUT_MS = 3; // Frames are 7ms apart, bytes ~87us apart
+  static const uint8_t FRAME_MAX = 32;
+
+  static const uint8_t FRAME_LENGTH = 0x20;
+  static const uint8_t COMMAND_SERVO = 0x40;
+  static const uint8_t CHANNELS = 14;
+
+  static const char *name() { return "IBUS"; }
+
+  static uint8_t receive(RxFrames &rx, uint8_t byte) {
+    if (rx.index == 0) {
+      // Look for length byte
+      if (byte != FRAME_LENGTH) return RX_DROP;
+      rx.check = 0;
+    } else if (rx.index == 1) {
+      // Only servo frames carry channel data
+      if (byte != COMMAND_SERVO) return RX_DROP;
+    }
+
+    rx.store(byte);
+    if (rx.index <= FRAME_LENGTH - 2) {
+      rx.check += byte;
+      return RX_MORE;
+    }
+    if (rx.index < FRAME_LENGTH) return RX_MORE;
+
+    const uint8_t *frame = rx.frame();
+    uint16_t received = frame[30] | (frame[31] << 8);
+    return ((uint16_t)(0xFFFF - rx.check) == received) ? RX_FRAME : RX_BAD;
+  }
+
+  static bool unpack(const uint8_t *frame) {
+    for (int i = 0; i < CHANNELS; i++) {
+      channelData[i] = frame[2 + i * 2] | (frame[3 + i * 2] << 8);
+    }
+
+    #ifdef DEBUG
+      printChannels(name());
+    #endif
+
+    return true;
+  }
+};
+
+// CRSF protocol implementation
+// CRSF frame format: SYNC(0xC8) + LENGTH + TYPE + PAYLOAD + CRC
+// RC Channels payload: 16 channels, 11-bit each, packed into 22 bytes
+// CRC8 DVB-S2 (poly 0xD5) over type and payload, one table step per byte
+static const uint8_t crsfCrcTable[256] PROGMEM = {
+  0x00, 0xD5, 0x7F, 0xAA, 0xFE, 0x2B, 0x81, 0x54, 0x29, 0xFC, 0x56, 0x83, 0xD7, 0x02, 0xA8, 0x7D,
+  0x52, 0x87, 0x2D, 0xF8, 0xAC, 0x79, 0xD3, 0x06, 0x7B, 0xAE, 0x04, 0xD1, 0x85, 0x50, 0xFA, 0x2F,
+  0xA4, 0x71, 0xDB, 0x0E, 0x5A, 0x8F, 0x25, 0xF0, 0x8D, 0x58, 0xF2, 0x27, 0x73, 0xA6, 0x0C, 0xD9,
+  0xF6, 0x23, 0x89, 0x5C, 0x08, 0xDD, 0x77, 0xA2, 0xDF, 0x0A, 0xA0, 0x75, 0x21, 0xF4, 0x5E, 0x8B,
+  0x9D, 0x48, 0xE2, 0x37, 0x63, 0xB6, 0x1C, 0xC9, 0xB4, 0x61, 0xCB, 0x1E, 0x4A, 0x9F, 0x35, 0xE0,
+  0xCF, 0x1A, 0xB0, 0x65, 0x31, 0xE4, 0x4E, 0x9B, 0xE6, 0x33, 0x99, 0x4C, 0x18, 0xCD, 0x67, 0xB2,
+  0x39, 0xEC, 0x46, 0x93, 0xC7, 0x12, 0xB8, 0x6D, 0x10, 0xC5, 0x6F, 0xBA, 0xEE, 0x3B, 0x91, 0x44,
+  0x6B, 0xBE, 0x14, 0xC1, 0x95, 0x40, 0xEA, 0x3F, 0x42, 0x97, 0x3D, 0xE8, 0xBC, 0x69, 0xC3, 0x16,
+  0xEF, 0x3A, 0x90, 0x45, 0x11, 0xC4, 0x6E, 0xBB, 0xC6, 0x13, 0xB9, 0x6C, 0x38, 0xED, 0x47, 0x92,
+  0xBD, 0x68, 0xC2, 0x17, 0x43, 0x96, 0x3C, 0xE9, 0x94, 0x41, 0xEB, 0x3E, 0x6A, 0xBF, 0x15, 0xC0,
+  0x4B, 0x9E, 0x34, 0xE1, 0xB5, 0x60, 0xCA, 0x1F, 0x62, 0xB7, 0x1D, 0xC8, 0x9C, 0x49, 0xE3, 0x36,
+  0x19, 0xCC, 0x66, 0xB3, 0xE7, 0x32, 0x98, 0x4D, 0x30, 0xE5, 0x4F, 0x9A, 0xCE, 0x1B, 0xB1, 0x64,
+  0x72, 0xA7, 0x0D, 0xD8, 0x8C, 0x59, 0xF3, 0x26, 0x5B, 0x8E, 0x24, 0xF1, 0xA5, 0x70, 0xDA, 0x0F,
+  0x20, 0xF5, 0x5F, 0x8A, 0xDE, 0x0B, 0xA1, 0x74, 0x09, 0xDC, 0x76, 0xA3, 0xF7, 0x22, 0x88, 0x5D,
+  0xD6, 0x03, 0xA9, 0x7C, 0x28, 0xFD, 0x57, 0x82, 0xFF, 0x2A, 0x80, 0x55, 0x01, 0xD4, 0x7E, 0xAB,
+  0x84, 0x51, 0xFB, 0x2E, 0x7A, 0xAF, 0x05, 0xD0, 0xAD, 0x78, 0xD2, 0x07, 0x53, 0x86, 0x2C, 0xF9,
+};
+
+uint8_t rcCrc8(uint8_t crc, uint8_t byte) {
+  return pgm_read_byte(&crsfCrcTable[crc ^ byte]);
+}
+
+struct CrsfProtocol {
+  static const uint32_t BAUD = 420000; // CRSF standard baud rate
+  static const uint8_t FORMAT = HAL_SERIAL_8N1;
+  static const uint8_t BYTE_TIMEOUT_MS = 10;
+  static const uint8_t FRAME_MAX = 26;
+
+  static const uint8_t SYNC_BYTE = 0xC8;
+  static const uint8_t FRAME_RC_CHANNELS = 0x16;
+  static const uint8_t RC_CHANNELS_PAYLOAD_SIZE = 22;
+
+  static const char *name() { return "CRSF"; }
+
+  static uint8_t receive(RxFrames &rx, uint8_t byte) {
+    if (rx.index == 0) {
+      // Look for sync byte
+      if (byte != SYNC_BYTE) return RX_DROP;
+    } else if (rx.index == 1) {
+      // Frame length byte
+      if (byte < 3 || byte > 62) return RX_DROP; // Valid CRSF frame length range
+      rx.expectedLength = byte + 2; // +2 for sync and length bytes
+      rx.check = 0;
+    }
+
+    rx.store(byte);
+    if (rx.index <= 2) return RX_MORE;
+
+    if (rx.index < rx.expectedLength) {
+      // CRC covers type and payload, not sync, length or the CRC itself
+      rx.check = pgm_read_byte(&crsfCrcTable[rx.check ^ byte]);
+      return RX_MORE;
+    }
+
+    // Only RC channel frames are published, other frame types are skipped
+    const uint8_t *frame = rx.frame();
+    if (frame[2] != FRAME_RC_CHANNELS ||
+        frame[1] != (RC_CHANNELS_PAYLOAD_SIZE + 2)) { // +2 for type and CRC
+      return RX_SKIP;
+    }
+    return (rx.check == byte) ? RX_FRAME : RX_BAD;
+  }
+
+  static bool unpack(const uint8_t *frame) {
+    unpack11(&frame[3], RC_CHANNELS_PAYLOAD_SIZE); // Skip sync, length, type
+
+    #ifdef DEBUG
+      printChannels(name());
+    #endif
+
+    return true;
+  }
+};
+
+// SBUS protocol implementation
+// SBUS frame format: 0x0F + 22 data bytes + flags + 0x00/0x04/0x14/0x24
+// 16 channels, 11-bit each, packed into 22 bytes
+// Uses hardware inverter on PCB connected to RX pin
+struct SbusProtocol {
+  static const uint32_t BAUD = 100000; // SBUS: 100000 baud, 8 data, even parity, 2 stop
+  static const uint8_t FORMAT = HAL_SERIAL_8E2;
+  static const uint8_t BYTE_TIMEOUT_MS = 15;
+  static const uint8_t FRAME_MAX = 25;
+
+  static const uint8_t HEADER = 0x0F;
+  static const uint8_t FOOTER_MASK = 0xF0; // Footer can be 0x00, 0x04, 0x14, 0x24
+
+  static const char *name() { return "SBUS"; }
+
+  static uint8_t receive(RxFrames &rx, uint8_t byte) {
+    // Look for header byte
+    if (rx.index == 0 && byte != HEADER) return RX_DROP;
+
+    rx.store(byte);
+    if (rx.index < FRAME_MAX) return RX_MORE;
+
+    // Verify footer byte. The failsafe flag is latched here, so the watchdog
+    // sees it without waiting for unpack().
+    if ((byte & FOOTER_MASK) == 0x00 || byte == 0x04 || byte == 0x14 || byte == 0x24) {
+      rcLink.receiverFailsafe = (rx.frame()[23] & 0x08) != 0;
+      return RX_FRAME;
+    }
+    return RX_BAD;
+  }
+
+  static bool unpack(const uint8_t *frame) {
+    // Extract channel data from bytes 1-22
+    const uint8_t *data = &frame[1];
+    uint16_t channels[16];
+
+    // Unpack 16 channels from 22 bytes (11-bit channels)
+    channels[0]  = ((data[0]    | data[1]<<8))                 & 0x07FF;
+    channels[1]  = ((data[1]>>3 | data[2]<<5))                 & 0x07FF;
+    channels[2]  = ((data[2]>>6 | data[3]<<2 | data[4]<<10))   & 0x07FF;
+    channels[3]  = ((data[4]>>1 | data[5]<<7))                 & 0x07FF;
+    channels[4]  = ((data[5]>>4 | data[6]<<4))                 & 0x07FF;
+    channels[5]  = ((data[6]>>7 | data[7]<<1 | data[8]<<9))    & 0x07FF;
+    channels[6]  = ((data[8]>>2 | data[9]<<6))                 & 0x07FF;
+    channels[7]  = ((data[9]>>5 | data[10]<<3))                & 0x07FF;
+    channels[8]  = ((data[11]   | data[12]<<8))                & 0x07FF;
+    channels[9]  = ((data[12]>>3| data[13]<<5))                & 0x07FF;
+    channels[10] = ((data[13]>>6| data[14]<<2 | data[15]<<10)) & 0x07FF;
+    channels[11] = ((data[15]>>1| data[16]<<7))                & 0x07FF;
+    channels[12] = ((data[16]>>4| data[17]<<4))                & 0x07FF;
+    channels[13] = ((data[17]>>7| data[18]<<1 | data[19]<<9))  & 0x07FF;
+    channels[14] = ((data[19]>>2| data[20]<<6))                & 0x07FF;
+    channels[15] = ((data[20]>>5| data[21]<<3))                & 0x07FF;
+
+    // Convert SBUS channel range (172-1811) to standard RC range (1000-2000)
+    for (int i = 0; i < 16; i++) {
+      if (channels[i] < 172) channels[i] = 172;
+      if (channels[i] > 1811) channels[i] = 1811;
+      channelData[i] = 1000 + rcScale(channels[i] - 172, RC_SCALE_11BIT_MUL, RC_SCALE_11BIT_SHIFT);
+    }
+
+    // Check failsafe and frame lost flags from byte 23
+    uint8_t flags = frame[23];
+    bool frameLost = (flags & 0x04) != 0;
+    bool failsafe = (flags & 0x08) != 0;
+
+    if (frameLost) rcLink.lostFrames++;
+    if (failsafe) rcLink.failsafeFrames++;
+    if (frameLost || failsafe) {
+      #ifdef DEBUG
+        if (frameLost) halDebugPrintln("SBUS: Frame lost flag set");
+        if (failsafe) halDebugPrintln("SBUS: Failsafe flag set");
+      #endif
+      return false;
+    }
+
+    #ifdef DEBUG
+      printChannels(name());
+    #endif
+
+    return true;
+  }
+};
+
+// DSM2/DSMX protocol implementation
+// DSM frame format: 16 bytes total, 8 channel pairs (2 bytes each)
+// DSM2: 10-bit resolution, DSMX: 11-bit resolution
+// Both protocols use the same frame format but different bit allocation
+template <bool is11bit>
+struct DsmProtocol {
+  static const uint32_t BAUD = 115200; // DSM uses 115200 baud
+  static const uint8_t FORMAT = HAL_SERIAL_8N1;
+  static const uint8_t BYTE_TIMEOUT_MS = 5; // Frame takes 1.4ms, the gap after it is at least 9.6ms (11ms frames)
+  static const uint8_t FRAME_MAX = 16;
+
+  static const char *name() { return is11bit ? "DSMX" : "DSM2"; }
+
+  static uint8_t receive(RxFrames &rx, uint8_t byte) {
+    // No sync byte, frames are only delimited by the gap between them
+    rx.store(byte);
+    return (rx.index < FRAME_MAX) ? RX_MORE : RX_FRAME;
+  }
+
+  static bool unpack(const uint8_t *frame) {
+    // Skip first 2 bytes (fade count and system data)
+    uint16_t channels[16];
+    for (int i = 0; i < 16; i++) channels[i] = 1500; // Initialize to center
+
+    for (int i = 1; i < 8; i++) { // Process 7 channel pairs (skip first pair)
+      uint16_t channelData = (frame[i*2] << 8) | frame[i*2 + 1];
+
+      if (channelData != 0xFFFF) { // Valid channel data
+        uint8_t channelNum;
+        uint16_t channelValue;
+
+        if (is11bit) {
+          // DSMX 11-bit format
+          channelNum = (channelData >> 11) & 0x0F;
+          channelValue = channelData & 0x07FF;
+          // Convert 11-bit (0-2047) to standard range (1000-2000)
+          if (channelNum < 16) {
+            channels[channelNum] = 1000 + rcScale(channelValue, RC_SCALE_DSMX_MUL, RC_SCALE_DSMX_SHIFT);
+          }
+        } else {
+          // DSM2 10-bit format
+          channelNum = (channelData >> 10) & 0x0F;
+          channelValue = channelData & 0x03FF;
+          // Convert 10-bit (0-1023) to standard range (1000-2000)
+          if (channelNum < 16) {
+            channels[channelNum] = 1000 + rcScale(channelValue, RC_SCALE_DSM2_MUL, RC_SCALE_DSM2_SHIFT);
+          }
+        }
+      }
+    }
+
+    // Copy valid channels to global array
+    for (int i = 0; i < 16; i++) {
+      channelData[i] = channels[i];
+    }
+
+    #ifdef DEBUG
+      printChannels(name());
+    #endif
+
+    return true;
+  }
+};
+
+// DSM frames carry no checksum, so auto detection would take any 16 bytes at
+// 115200 for one. Its DSM candidates only accept frames with a known system
+// byte: 0x01 (1024 resolution) for DSM2, 0x12, 0xA2 or 0xB2 (2048) for DSMX.
+template <bool is11bit>
+struct DsmDetectProtocol : DsmProtocol<is11bit> {
+  static uint8_t receive(RxFrames &rx, uint8_t byte) {
+    uint8_t result = DsmProtocol<is11bit>::receive(rx, byte);
+    if (result != RX_FRAME) return result;
+
+    uint8_t system = rx.frame()[1];
+    bool known = is11bit ? (system == 0x12 || system == 0xA2 || system == 0xB2) : system == 0x01;
+    return known ? RX_FRAME : RX_BAD;
+  }
+};
+
+// FPORT protocol implementation
+// FPORT frame format: 0x7E + LENGTH + TYPE + PAYLOAD + CRC + 0x7E
+// RC Channels: Type 0x00, 24 bytes payload (16 channels, 11-bit each)
+struct FportProtocol {
+  static const uint32_t BAUD = 115200; // FPORT uses 115200 baud
+  static const uint8_t FORMAT = HAL_SERIAL_8N1;
+  static const uint8_t BYTE_TIMEOUT_MS = 15;
+  static const uint8_t FRAME_MAX = 32;
+
+  static const uint8_t HEADER = 0x7E;
+  static const uint8_t RC_CHANNELS_TYPE = 0x00;
+  static const uint8_t RC_CHANNELS_LENGTH = 0x18; // 24 bytes payload
+
+  static const char *name() { return "FPORT"; }
+
+  static uint8_t receive(RxFrames &rx, uint8_t byte) {
+    if (rx.index == 0) {
+      // Start of frame
+      if (byte != HEADER) return RX_DROP;
+    } else if (rx.index == 1) {
+      // Length byte. A second 0x7E means the first one was the footer of the
+      // previous frame, so this one starts the frame.
+      if (byte == HEADER) return RX_MORE;
+      if (byte != RC_CHANNELS_LENGTH) return RX_SKIP; // Telemetry polls and other frame types
+      rx.expectedLength = byte + 4; // +4 for header, length, type, CRC, footer
+    }
+
+    rx.store(byte);
+    if (rx.index <= 2) return RX_MORE;
+
+    // Check if frame is complete
+    if (rx.index < rx.expectedLength || byte != HEADER) {
+      return (rx.index < FRAME_MAX) ? RX_MORE : RX_DROP; // No closing header, resync
+    }
+
+    const uint8_t *frame = rx.frame();
+    if (frame[2] != RC_CHANNELS_TYPE) return RX_SKIP;
+
+    // Calculate CRC (simple XOR of payload)
+    uint8_t calculatedCRC = 0;
+    for (uint8_t i = 3; i < rx.index - 2; i++) { // Skip header, length, type, CRC, footer
+      calculatedCRC ^= frame[i];
+    }
+    return (calculatedCRC == frame[rx.index - 2]) ? RX_FRAME : RX_BAD;
+  }
+
+  static bool unpack(const uint8_t *frame) {
+    // FPORT channels are packed similar to SBUS/CRSF (11-bit)
+    unpack11(&frame[3], RC_CHANNELS_LENGTH - 1); // Skip header, length, type
+
+    #ifdef DEBUG
+      printChannels(name());
+    #endif
+
+    return true;
+  }
+};
+
+// PPM state structure - only allocated when PPM protocol is used
+struct PPMState {
+  volatile uint32_t pulseStartTime;
+  volatile uint16_t channelValues[16];
+  volatile uint8_t channelCount;
+  volatile bool frameComplete;
+  volatile uint8_t currentChannel;
+  volatile uint32_t lastValidFrame;   // Timestamp of last valid frame
+  volatile uint8_t missedFrames;          // Invalid frames since the last valid one, rcLink.errors keeps the total
+};
+
+// PPM is edge driven, so it implements begin()/read() itself
+struct PpmDecoder {
+  static const uint16_t PPM_MAX_PULSE_WIDTH = 2100;
+  static const uint32_t PPM_STALE_FRAME = 100000; // us, older complete frames are not reported
+  static const uint8_t PPM_NO_FRAME = 0xFF;       // currentChannel after a dropout, wait for the next sync gap
+
+  static PPMState *state; // Only allocated when needed
+
+  // PPM interrupt service routine
+  static void edge() {
+    if (!state) return; // Safety check
+
+    const uint16_t PPM_MIN_PULSE_WIDTH = 900;   // Tighter range
+    const uint16_t PPM_SYNC_GAP = 3000;         // Lower sync gap threshold
+    const uint16_t PPM_MAX_SYNC_GAP = 25000;    // Maximum reasonable sync gap
+
+    uint32_t currentTime = halMicros();
+    uint32_t pulseWidth = currentTime - state->pulseStartTime;
+    state->pulseStartTime = currentTime;
+
+    // Ignore very short pulses (noise rejection)
+    if (pulseWidth < 500) {
+      return;
+    }
+
+    // The signal dropped out, the pulses so far belong to no frame
+    if (pulseWidth > PPM_MAX_SYNC_GAP) {
+      state->currentChannel = PPM_NO_FRAME;
+      return;
+    }
+
+    if (pulseWidth > PPM_SYNC_GAP) {
+      // Sync pulse detected - validate and start new frame
+      if (state->currentChannel == PPM_NO_FRAME) {
+        // First sync after a dropout, nothing to validate
+      } else if (state->currentChannel >= 4 && state->currentChannel <= 16) {
+        // Valid frame completed
+        state->channelCount = state->currentChannel;
+        state->frameComplete = true;
+        state->lastValidFrame = currentTime;
+        state->missedFrames = 0;
+        rcLinkFrame();
+      } else {
+        // Invalid frame
+        state->missedFrames++;
+        rcLinkError();
+      }
+      state->currentChannel = 0;
+    } else if (pulseWidth >= PPM_MIN_PULSE_WIDTH && pulseWidth <= PPM_MAX_PULSE_WIDTH) {
+      // Valid channel pulse - store directly for maximum responsiveness
+      if (state->currentChannel < 16) {
+        state->channelValues[state->currentChannel] = pulseWidth;
+        state->currentChannel++;
+      }
+    }
+    // Ignore pulses outside valid range (noise rejection)
+  }
+
+  static void begin() {
+    if (!state) state = new PPMState(); // Auto detection starts it again and again
+    state->pulseStartTime = 0;
+    state->channelCount = 0;
+    state->frameComplete = false;
+    state->currentChannel = 0;
+    state->lastValidFrame = 0;
+    state->missedFrames = 0;
+
+    // Initialize with center values
+    for (int i = 0; i < 16; i++) {
+      state->channelValues[i] = 1500;
+    }
+
+    halAttachPPM(edge);
+
+    #ifdef DEBUG
+      halDebugPrintln("PPM interrupt attached to pin 0");
+    #endif
+  }
+
+  static bool read() {
+    if (!state) return false;
+
+    // A frame the loop did not pick up in time is dropped, not reported late
+    halNoInterrupts();
+    if (state->frameComplete && halMicros() - state->lastValidFrame > PPM_STALE_FRAME) {
+      state->frameComplete = false;
+    }
+    halInterrupts();
+
+    if (state->frameComplete && state->channelCount >= 4) {
+      // Check if too many frames were missed (signal quality check)
+      if (state->missedFrames > 20) { // More lenient threshold
+        #ifdef DEBUG
+          halDebugPrintln("PPM: Too many missed frames, signal unstable");
+        #endif
+        return false;
+      }
+
+      // Copy data directly for maximum responsiveness
+      halNoInterrupts();
+      for (int i = 0; i < state->channelCount && i < 16; i++) {
+        channelData[i] = state->channelValues[i];
+      }
+      state->frameComplete = false;
+      halInterrupts();
+
+      #ifdef DEBUG
+        printChannels("PPM");
+      #endif
+
+      return true;
+    }
+
+    return false;
+  }
+
+  // Inside the sync gap, no edge is due before the next frame
+  static bool quiet() {
+    if (!state) return true;
+    halNoInterrupts();
+    uint32_t lastEdge = state->pulseStartTime;
+    halInterrupts();
+    return (halMicros() - lastEdge) > PPM_MAX_PULSE_WIDTH;
+  }
+};
+
+PPMState *PpmDecoder::state = nullptr;
+
+// PPM on pin 4, timed by the Timer1 input capture unit at 0.5us per tick. The
+// interrupt only queues the interval between two rising edges, read() turns
+// the queued intervals into frames with the same limits as PpmDecoder.
+struct PpmCaptureDecoder {
+  static const uint8_t QUEUE_SIZE = 32;   // Power of two, covers more than one frame of edges
+  static const uint8_t NO_FRAME = 0xFF;   // Edges were lost, wait for the next sync gap
+
+  static const uint16_t NOISE = 500 * HAL_CAPTURE_TICKS_PER_US;
+  static const uint16_t MIN_PULSE = 900 * HAL_CAPTURE_TICKS_PER_US;
+  static const uint16_t MAX_PULSE = 2100 * HAL_CAPTURE_TICKS_PER_US;
+  static const uint16_t SYNC_GAP = 3000 * HAL_CAPTURE_TICKS_PER_US;
+  static const uint16_t MAX_SYNC_GAP = 25000 * HAL_CAPTURE_TICKS_PER_US;
+
+  static volatile uint16_t queue[QUEUE_SIZE];
+  static volatile uint8_t head;           // Next slot the interrupt writes
+  static volatile uint8_t tail;           // Next slot read() takes
+  static volatile bool overrun;
+  static uint16_t pulses[16];             // Ticks
+  static uint8_t currentChannel;
+
+  // Interrupt context
+  static void capture(uint16_t ticks) {
+    uint8_t next = (head + 1) & (QUEUE_SIZE - 1);
+    if (next == tail) {
+      overrun = true;
+      return;
+    }
+    queue[head] = ticks;
+    head = next;
+  }
+
+  // One interval between rising edges, true when it closed a valid frame
+  static bool interval(uint16_t ticks) {
+    if (ticks < NOISE) return false;
+    if (ticks > MAX_SYNC_GAP) {
+      // The signal dropped out, the pulses so far belong to no frame
+      currentChannel = NO_FRAME;
+      return false;
+    }
+
+    if (ticks > SYNC_GAP) {
+      bool valid = currentChannel >= 4 && currentChannel <= 16;
+      if (valid) {
+        for (uint8_t i = 0; i < currentChannel; i++) {
+          channelData[i] = (pulses[i] + HAL_CAPTURE_TICKS_PER_US / 2) / HAL_CAPTURE_TICKS_PER_US;
+        }
+        rcLinkFrame();
+      } else if (currentChannel != NO_FRAME) {
+        rcLinkError();
+      }
+      currentChannel = 0;
+      return valid;
+    }
+
+    if (ticks >= MIN_PULSE && ticks <= MAX_PULSE && currentChannel < 16) {
+      pulses[currentChannel++] = ticks;
+    }
+    return false;
+  }
+
+  static void begin() {
+    head = tail = 0;
+    overrun = false;
+    currentChannel = NO_FRAME;
+    halAttachPPMCapture(capture);
+
+    #ifdef DEBUG
+      halDebugPrintln("PPM input capture attached to pin 4");
+    #endif
+  }
+
+  static bool read() {
+    if (overrun) {
+      // The loop fell behind and edges were dropped, the current frame is lost
+      tail = head;
+      overrun = false;
+      currentChannel = NO_FRAME;
+      rcLinkOverrun();
+    }
+
+    bool frame = false;
+    while (tail != head) {
+      uint16_t ticks = queue[tail];
+      tail = (tail + 1) & (QUEUE_SIZE - 1);
+      if (interval(ticks)) frame = true;
+    }
+
+    #ifdef DEBUG
+      if (frame) printChannels("PPM");
+    #endif
+
+    return frame;
+  }
+
+  // The edge time is latched by the timer, so an interrupt lockout only
+  // delays the queueing
+  static bool quiet() {
+    return true;
+  }
+};
+
+volatile uint16_t PpmCaptureDecoder::queue[PpmCaptureDecoder::QUEUE_SIZE];
+volatile uint8_t PpmCaptureDecoder::head = 0;
+volatile uint8_t PpmCaptureDecoder::tail = 0;
+volatile bool PpmCaptureDecoder::overrun = false;
+uint16_t PpmCaptureDecoder::pulses[16];
+uint8_t PpmCaptureDecoder::currentChannel = PpmCaptureDecoder::NO_FRAME;
+
+#define UART_DECODER(id, protocol) \
+  {id, UartDecoder<protocol>::begin, UartDecoder<protocol>::read, UartDecoder<protocol>::quiet}
+#define PPM_DECODER(id, decoder) {id, decoder::begin, decoder::read, decoder::quiet}
+
+// Candidates for auto detection, in the order they are tried. Protocols that
+// share a baud rate follow each other.
+struct AutoCandidate {
+  RcDecoder decoder;
+  uint8_t listenMs;   // Two of the protocol's slowest frame periods: time to sync and see one whole frame
+};
+
+static constexpr AutoCandidate autoCandidates[] PROGMEM = {
+  {UART_DECODER(IBUS, IBusProtocol), 15},               // 115200 8N1, 7ms
+  {UART_DECODER(FPORT, FportProtocol), 20},             // 9ms
+  {UART_DECODER(DSMX, DsmDetectProtocol<true>), 45},    // 11 or 22ms
+  {UART_DECODER(DSM2, DsmDetectProtocol<false>), 45},   // 22ms
+  {UART_DECODER(SBUS, SbusProtocol), 30},               // 100000 8E2, 7 or 14ms
+  {UART_DECODER(CRSF, CrsfProtocol), 45},               // 420000 8N1, 4 to 20ms
+  {PPM_DECODER(PPM, PpmDecoder), 50},                   // Edges on pin 0, up to 22.5ms
+  {PPM_DECODER(PPM_CAPTURE, PpmCaptureDecoder), 50},    // Edges on pin 4
+};
+
+#define AUTO_CANDIDATES (sizeof(autoCandidates) / sizeof(autoCandidates[0]))
+
+constexpr uint16_t autoCycleMs(uint8_t i = 0) {
+  return i < AUTO_CANDIDATES ? autoCandidates[i].listenMs + autoCycleMs(i + 1) : 0;
+}
+
+static_assert(autoCycleMs() == AUTO_CYCLE_MS, "AUTO_CYCLE_MS must be the sum of the listen times");
+
+// Protocol auto detection. Until a protocol is found, the candidates take
+// turns on the input, each started on its own and listening for its
+// listenMs. Every valid frame gives the candidate another listenMs, unless
+// more than one checksum error or resync came before it, and after
+// AUTO_LOCK_FRAMES valid frames in a row without a checksum error the input
+// locks onto it. From then on read() is the candidate's read() plus one
+// check: after AUTO_RELOCK_MS without a valid frame the search starts over,
+// with the protocol that was lost.
+//
+// A candidate only sees bytes at its own baud rate and framing, so the wrong
+// ones get nothing or garbage that fails the sync and checksum checks. The odd
+// garbage frame that passes (DSM and SBUS carry no checksum) comes after a run
+// of rejects, so it does not keep the candidate listening. While searching,
+// unpacked frames are not reported.
+struct AutoDecoder {
+  static AutoCandidate candidate;   // Copy of autoCandidates[current]
+  static uint8_t current;
+  static bool locked;
+  static uint32_t listenSince;      // Start of the listen time, or the last valid frame
+  static uint32_t frames;           // rcLink counters at the last look
+  static uint32_t errors;
+  static uint32_t resyncs;
+  static uint16_t streak;           // Valid frames in a row
+  static uint16_t rejects;          // Checksum errors and resyncs since the last valid frame
+
+  static void listen(uint8_t index) {
+    halInputEnd();
+    rcLink.receiverFailsafe = false;
+    current = index;
+    memcpy_P(&candidate, &autoCandidates[index], sizeof(candidate));
+
+    RcLinkStats stats;
+    readRcLinkStats(&stats);
+    frames = stats.frames;
+    errors = stats.errors;
+    resyncs = stats.resyncs;
+    streak = 0;
+    rejects = 0;
+    listenSince = halMillis();
+    candidate.decoder.begin();
+  }
+
+  static void begin() {
+    locked = false;
+    listen(0);
+  }
+
+  static bool read() {
+    bool frame = candidate.decoder.read();
+
+    if (locked) {
+      if (rcFrameAge() <= AUTO_RELOCK_MS) return frame;
+      locked = false;
+      listen(current);
+      #ifdef DEBUG
+        halDebugPrintln("AUTO: Signal lost, searching");
+      #endif
+      return false;
+    }
+
+    RcLinkStats stats;
+    readRcLinkStats(&stats);
+    uint32_t now = halMillis();
+    if (rejects < 0xFF) rejects += (stats.resyncs - resyncs) + (stats.errors - errors);
+    resyncs = stats.resyncs;
+    if (stats.errors != errors) {
+      errors = stats.errors;
+      streak = 0;
+    }
+    if (stats.frames != frames) {
+      streak += stats.frames - frames;
+      frames = stats.frames;
+      if (rejects <= 1) listenSince = now; // More is noise that happened to pass
+      rejects = 0;
+    }
+
+    if (streak >= AUTO_LOCK_FRAMES) {
+      locked = true;
+      #ifdef DEBUG
+        halDebugPrint("AUTO: Locked, protocol ");
+        halDebugPrintln((int32_t)candidate.decoder.protocol);
+      #endif
+      return frame;
+    }
+    if (now - listenSince > candidate.listenMs) {
+      listen((current + 1) % AUTO_CANDIDATES);
+    }
+    return false;
+  }
+
+  static bool quiet() {
+    return candidate.decoder.quiet();
+  }
+
+  static uint8_t protocol() {
+    return locked ? candidate.decoder.protocol : 0;
+  }
+};
+
+AutoCandidate AutoDecoder::candidate;
+uint8_t AutoDecoder::current = 0;
+bool AutoDecoder::locked = false;
+uint32_t AutoDecoder::listenSince = 0;
+uint32_t AutoDecoder::frames = 0;
+uint32_t AutoDecoder::errors = 0;
+uint32_t AutoDecoder::resyncs = 0;
+uint16_t AutoDecoder::streak = 0;
+uint16_t AutoDecoder::rejects = 0;
+
+// Adding a protocol: write its class above and list it here
+static const RcDecoder decoders[] = {
+  UART_DECODER(IBUS, IBusProtocol),   // First entry is the fallback
+  UART_DECODER(SBUS, SbusProtocol),
+  UART_DECODER(CRSF, CrsfProtocol),
+  UART_DECODER(DSMX, DsmProtocol<true>),
+  UART_DECODER(DSM2, DsmProtocol<false>),
+  UART_DECODER(FPORT, FportProtocol),
+  PPM_DECODER(PPM, PpmDecoder),
+  PPM_DECODER(PPM_CAPTURE, PpmCaptureDecoder),
+  {AUTO, AutoDecoder::begin, AutoDecoder::read, AutoDecoder::quiet},
+};
+
+static const RcDecoder *activeDecoder = nullptr;
+
+// Bind and start the decoder for config.protocol
+void beginRcInput() {
+  activeDecoder = &decoders[0];
+  for (uint8_t i = 0; i < sizeof(decoders) / sizeof(decoders[0]); i++) {
+    if (decoders[i].protocol == config.protocol) {
+      activeDecoder = &decoders[i];
+      break;
+    }
+  }
+  beginChannelFilter();
+  beginChannelConditioning();
+  rcLink.receiverFailsafe = false;
+  activeDecoder->begin();
+}
+
+void endRcInput() {
+  if (!activeDecoder) return;
+  halInputEnd();
+  activeDecoder = nullptr;
+}
+
+// Read data from the bound decoder
+bool readProtocol() {
+  if (!readRawProtocol()) return false;
+  conditionChannels();
+  return true;
+}
+
+bool readRawProtocol() {
+  if (!activeDecoder->read()) return false;
+  filterChannels();
+  return true;
+}
+
+bool rcInputRunning() {
+  return activeDecoder != nullptr;
+}
+
+uint8_t rcInputProtocol() {
+  if (!activeDecoder) return 0;
+  return (activeDecoder->protocol == AUTO) ? AutoDecoder::protocol() : activeDecoder->protocol;
+}
+
+bool rcInputQuiet() {
+  return !activeDecoder || activeDecoder->quiet();
+}
@@ -0,0 +1,46 @@
+#include "serial_frame.h"
+#include "rc_input.h"
+
+static uint8_t frameCrc(const uint8_t *data, uint8_t length) {
+  uint8_t crc = 0;
+  for (uint8_t i = 0; i < length; i++) {
+    crc = rcCrc8(crc, data[i]);
+  }
+  return crc;
+}
+
+uint8_t encodeSerialFrame(uint8_t *payload, uint8_t length, uint8_t *out) {
+  payload[length] = frameCrc(payload, length);
+  length++;
+
+  uint8_t code = 0;       // Index of the pending distance byte
+  uint8_t n = 1;
+  for (uint8_t i = 0; i < length; i++) {
+    if (payload[i] == 0) {
+      out[code] = n - code;
+      code = n++;
+    } else {
+      out[n++] = payload[i];
+    }
+  }
+  out[code] = n - code;
+  out[n++] = 0;
+  return n;
+}
+
+uint8_t decodeSerialFrame(const uint8_t *in, uint8_t length, uint8_t *payload) {
+  uint8_t n = 0;
+  uint8_t i = 0;
+  while (i < length) {
+    uint8_t code = in[i];
+    if (code == 0 || i + code > length) return 0;
+    for (uint8_t j = 1; j < code; j++) {
+      payload[n++] = in[i + j];
+    }
+    i += code;
+    if (i < length) payload[n++] = 0;
+  }
+
+  if (n < 2 || frameCrc(payload, n - 1) != payload[n - 1]) return 0;
+  return n - 1;
+}
@@ -0,0 +1,142 @@
+#include "status_led.h"
+#include "hal.h"
+#include "rc_input.h"
+
+// Every halLedShow() keeps interrupts off for the whole WS2812 transfer, so
+// the colour is only pushed when it changed, at most every
+// LED_MIN_INTERVAL_MS while RC input runs, and preferably in the gap between
+// two frames. An update is never held back longer than LED_MAX_DEFER_MS.
+#define LED_MIN_INTERVAL_MS 20
+#define LED_MAX_DEFER_MS    100
+
+// Non-blocking LED state variables
+struct LEDState {
+  uint8_t r, g, b;
+  uint32_t lastUpdate;
+  bool active;
+  uint8_t mode; // 0=solid, 1=flash, 2=pulse
+  uint8_t flashCount;
+  uint8_t flashesLeft;
+  int pulseDirection; // 1=up, -1=down
+  uint8_t pulseBrightness;
+} ledState = {0, 0, 0, 0, false, 0, 0, 0, 1, 0};
+
+struct LEDColor {
+  uint8_t r, g, b;
+};
+
+static LEDColor ledTarget = {0, 0, 0};   // Colour the effects want
+static LEDColor ledShown = {0, 0, 0};    // Colour last pushed, halLedBegin() starts dark
+static bool ledDirty = false;            // ledTarget differs from ledShown
+static uint32_t ledDirtySince = 0;
+static uint32_t ledLastShow = 0;
+
+// Request a colour, pushed by flushLED()
+static void writeLED(uint8_t r, uint8_t g, uint8_t b) {
+  ledTarget.r = r;
+  ledTarget.g = g;
+  ledTarget.b = b;
+  if (r == ledShown.r && g == ledShown.g && b == ledShown.b) {
+    ledDirty = false;
+  } else if (!ledDirty) {
+    ledDirty = true;
+    ledDirtySince = halMillis();
+  }
+}
+
+// Push the requested colour if it changed and the RC input allows it
+static void flushLED() {
+  if (!ledDirty) return;
+
+  if (rcInputRunning()) {
+    uint32_t now = halMillis();
+    if (now - ledLastShow < LED_MIN_INTERVAL_MS) return;
+    if (!rcInputQuiet() && now - ledDirtySince < LED_MAX_DEFER_MS) return;
+  }
+
+  halLedShow(ledTarget.r, ledTarget.g, ledTarget.b);
+  ledShown = ledTarget;
+  ledLastShow = halMillis();
+  ledDirty = false;
+}
+
+// Non-blocking LED utility functions
+void setLED(uint8_t r, uint8_t g, uint8_t b) {
+  writeLED(r, g, b);
+  // Stop any ongoing effects
+  ledState.active = false;
+  ledState.mode = 0;
+  flushLED();
+}
+
+void startFlashLED(uint8_t r, uint8_t g, uint8_t b, int count) {
+  ledState.r = r;
+  ledState.g = g;
+  ledState.b = b;
+  ledState.mode = 1; // Flash mode
+  ledState.flashCount = count;
+  ledState.flashesLeft = count * 2; // On and off states
+  ledState.lastUpdate = halMillis();
+  ledState.active = true;
+}
+
+void startPulseLED(uint8_t r, uint8_t g, uint8_t b) {
+  ledState.r = r;
+  ledState.g = g;
+  ledState.b = b;
+  ledState.mode = 2; // Pulse mode
+  ledState.pulseBrightness = 0;
+  ledState.pulseDirection = 1;
+  ledState.lastUpdate = halMillis();
+  ledState.active = true;
+}
+
+// Advance the flash or pulse effect, the colour goes out through flushLED()
+static void stepEffect() {
+  uint32_t now = halMillis();
+
+  if (ledState.mode == 1) { // Flash mode
+    if (now - ledState.lastUpdate >= 100) { // 100ms intervals
+      if (ledState.flashesLeft > 0) {
+        if (ledState.flashesLeft % 2 == 1) {
+          // Odd = turn on
+          writeLED(ledState.r, ledState.g, ledState.b);
+        } else {
+          // Even = turn off
+          writeLED(0, 0, 0);
+        }
+        ledState.flashesLeft--;
+        ledState.lastUpdate = now;
+      } else {
+        // Flash sequence complete, turn off
+        ledState.active = false;
+        writeLED(0, 0, 0);
+      }
+    }
+  } else if (ledState.mode == 2) { // Pulse mode
+    if (now - ledState.lastUpdate >= 20) { // 20ms intervals for smooth pulsing
+      ledState.pulseBrightness += ledState.pulseDirection * 5;
+
+      if (ledState.pulseBrightness >= 255) {
+        ledState.pulseBrightness = 255;
+        ledState.pulseDirection = -1;
+      } else if (ledState.pulseBrightness <= 0) {
+        ledState.pulseBrightness = 0;
+        ledState.pulseDirection = 1;
+      }
+
+      uint8_t r = (ledState.r * ledState.pulseBrightness) / 255;
+      uint8_t g = (ledState.g * ledState.pulseBrightness) / 255;
+      uint8_t b = (ledState.b * ledState.pulseBrightness) / 255;
+
+      writeLED(r, g, b);
+      ledState.lastUpdate = now;
+    }
+  }
+}
+
+// Steps the running effect, then pushes whatever colour is due
+void updateLED() {
+  if (ledState.active) stepEffect();
+  flushLED();
+}
@@ -0,0 +1,101 @@
+// Adaptive channel filter (channel_filter.cpp): steps a filtered channel up
+// and down and checks that it follows without overshooting.
+#include <stdio.h>
+#include <unity.h>
+#include "channel_filter.h"
+#include "config.h"
+#include "rc_input.h"
+
+// Runs the filter for a number of frames with the input held, true if the
+// output only moved towards the input and reached it
+static bool filterFollows(uint16_t input, uint16_t frames) {
+  uint16_t previous = channelData[0];
+  bool follows = true;
+  for (uint16_t i = 0; i < frames; i++) {
+    uint16_t from = previous;
+    channelData[0] = input;
+    filterChannels();
+    previous = channelData[0];
+    if (input >= from) follows &= previous >= from && previous <= input;
+    else follows &= previous <= from && previous >= input;
+  }
+  return follows && previous == input;
+}
+
+void setUp() {
+  generateDefaultSettings();
+  settings.filterCutoff[0] = 16;
+  settings.filterBeta[0] = 128;
+  beginChannelFilter();
+  channelData[0] = 1500;
+  filterChannels(); // Primes the filter
+}
+
+void tearDown() {
+}
+
+void test_steps_followed() {
+  TEST_ASSERT_TRUE_MESSAGE(filterFollows(1900, 200), "step up");
+  TEST_ASSERT_TRUE_MESSAGE(filterFollows(1100, 200), "step down");
+}
+
+void test_full_travel_followed() {
+  TEST_ASSERT_TRUE_MESSAGE(filterFollows(1000, 200), "down to 1000");
+  TEST_ASSERT_TRUE_MESSAGE(filterFollows(2000, 200), "up to 2000");
+}
+
+void test_small_step_down_followed() {
+  TEST_ASSERT_TRUE(filterFollows(2000, 200));
+  TEST_ASSERT_TRUE(filterFollows(1990, 200));
+}
+
+// Holds the input for a number of frames, returns the last output
+static uint16_t filterHold(uint16_t input, uint16_t frames) {
+  for (uint16_t i = 0; i < frames; i++) {
+    channelData[0] = input;
+    filterChannels();
+  }
+  return channelData[0];
+}
+
+// A small step has to settle on the input from below as well as from above,
+// even at the heaviest smoothing
+static void checkSmallSteps(uint8_t cutoff, uint8_t beta) {
+  char message[48];
+  snprintf(message, sizeof(message), "cutoff %u beta %u", cutoff, beta);
+  settings.filterCutoff[0] = cutoff;
+  settings.filterBeta[0] = beta;
+  beginChannelFilter();
+  channelData[0] = 1500;
+  filterChannels();
+
+  TEST_ASSERT_UINT_WITHIN_MESSAGE(1, 1510, filterHold(1510, 3000), message);
+  TEST_ASSERT_UINT_WITHIN_MESSAGE(1, 1500, filterHold(1500, 3000), message);
+  TEST_ASSERT_UINT_WITHIN_MESSAGE(1, 1501, filterHold(1501, 3000), message);
+  TEST_ASSERT_UINT_WITHIN_MESSAGE(1, 1499, filterHold(1499, 3000), message);
+}
+
+void test_small_steps_settle() {
+  static const uint8_t cutoffs[] = {1, 4, 16, 64};
+  for (uint8_t i = 0; i < sizeof(cutoffs); i++) {
+    checkSmallSteps(cutoffs[i], 0);
+    checkSmallSteps(cutoffs[i], 128);
+  }
+}
+
+// IBUS channels are not clamped to 1000-2000
+void test_values_outside_the_stick_range() {
+  TEST_ASSERT_TRUE_MESSAGE(filterFollows(5000, 200), "up to 5000");
+  TEST_ASSERT_TRUE_MESSAGE(filterFollows(65535, 200), "up to 65535");
+  TEST_ASSERT_TRUE_MESSAGE(filterFollows(0, 200), "down to 0");
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_steps_followed);
+  RUN_TEST(test_full_travel_followed);
+  RUN_TEST(test_small_step_down_followed);
+  RUN_TEST(test_small_steps_settle);
+  RUN_TEST(test_values_outside_the_stick_range);
+  return UNITY_END();
+}
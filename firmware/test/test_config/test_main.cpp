@@ -0,0 +1,145 @@
+// EEPROM record store (config.cpp): migration from the old fixed layout,
+// slot rotation and wear, falling back past a damaged record, the sequence
+// number wrapping, and what clear leaves alone.
+#include <stddef.h>
+#include <string.h>
+#include <unity.h>
+#include "config.h"
+#include "hal_native.h"
+
+// Slot holding the valid record with the newest sequence, -1 if none
+static int newestSlot() {
+  int newest = -1;
+  uint16_t sequence = 0;
+  for (int slot = 0; slot < STORE_SLOTS; slot++) {
+    StoreHeader header;
+    memcpy(&header, &nativeStore()[slot * STORE_SLOT_SIZE], sizeof(header));
+    if (header.magic != STORE_MAGIC) continue;
+    if (newest < 0 || (int16_t)(header.sequence - sequence) > 0) {
+      newest = slot;
+      sequence = header.sequence;
+    }
+  }
+  return newest;
+}
+
+// Wipes the RAM copy, so a load has to bring back mappings and settings
+static void forgetConfig() {
+  generateClearConfig();
+  generateDefaultSettings();
+}
+
+void setUp() {
+  nativeStoreErase();
+  generateDefaultConfig();
+}
+
+void tearDown() {
+}
+
+void test_erased_store_does_not_load() {
+  TEST_ASSERT_FALSE(loadConfigFromEEPROM());
+}
+
+// EEPROM as the firmware before the record store left it, with settings
+// saved before calibration existed
+void test_old_layout_migrates() {
+  config.protocol = CRSF;
+  config.throttle = 9;
+  config.buttons[31] = 16;
+  settings.reportKeepAlive = 1234;
+  settings.filterCutoff[4] = 42;
+  settings.size = offsetof(DeviceSettings, calibration);
+  JoystickConfig oldConfig = config;
+  DeviceSettings oldSettings = settings;
+  uint32_t signature = EEPROM_SIGNATURE;
+  uint8_t *store = nativeStore();
+  memcpy(&store[EEPROM_SIGNATURE_ADDR], &signature, sizeof(signature));
+  memcpy(&store[EEPROM_CONFIG_START_ADDR], &config, sizeof(config));
+  memcpy(&store[EEPROM_SETTINGS_ADDR], &settings, settings.size);
+
+  forgetConfig();
+  TEST_ASSERT_TRUE_MESSAGE(loadConfigFromEEPROM(), "old layout loads");
+  TEST_ASSERT_EQUAL_MEMORY_MESSAGE(&oldConfig, &config, sizeof(config), "mappings kept");
+  TEST_ASSERT_EQUAL_UINT16(1234, settings.reportKeepAlive);
+  TEST_ASSERT_EQUAL_UINT8(42, settings.filterCutoff[4]);
+  TEST_ASSERT_EQUAL_UINT8(oldSettings.filterBeta[4], settings.filterBeta[4]);
+  TEST_ASSERT_TRUE_MESSAGE(isDefaultCalibration(settings.calibration[0]), "missing calibration gets defaults");
+  TEST_ASSERT_EQUAL_UINT16(sizeof(settings), settings.size);
+  TEST_ASSERT_EQUAL_INT_MESSAGE(1, newestSlot(), "migrated record written to slot 1");
+  TEST_ASSERT_EQUAL_MEMORY_MESSAGE(&signature, &store[EEPROM_SIGNATURE_ADDR], sizeof(signature),
+                                   "old layout left intact by the migration");
+
+  forgetConfig();
+  TEST_ASSERT_TRUE_MESSAGE(loadConfigFromEEPROM(), "migrated record loads");
+  TEST_ASSERT_EQUAL_MEMORY(&oldConfig, &config, sizeof(config));
+  TEST_ASSERT_EQUAL_UINT16(1234, settings.reportKeepAlive);
+}
+
+// Every save moves on a slot. Sequence numbers wrap after 65536 saves.
+void test_saves_rotate_across_the_sequence_wrap() {
+  const uint32_t saves = 70000;
+  config.throttle = 9;
+  TEST_ASSERT_TRUE(saveConfigToEEPROM()); // First record, any slot
+  for (uint32_t i = 0; i < saves; i++) {
+    int before = newestSlot();
+    settings.reportMinInterval = i;
+    TEST_ASSERT_TRUE(saveConfigToEEPROM());
+    TEST_ASSERT_EQUAL_INT_MESSAGE((before + 1) % STORE_SLOTS, newestSlot(), "save goes to the next slot");
+  }
+
+  forgetConfig();
+  TEST_ASSERT_TRUE_MESSAGE(loadConfigFromEEPROM(), "newest record loads after the wrap");
+  TEST_ASSERT_EQUAL_UINT16((uint16_t)(saves - 1), settings.reportMinInterval);
+  TEST_ASSERT_EQUAL_UINT8(9, config.throttle);
+
+  uint32_t maxWrites = 0;
+  for (uint16_t i = 0; i < NATIVE_STORE_SIZE; i++) {
+    if (nativeStoreWrites(i) > maxWrites) maxWrites = nativeStoreWrites(i);
+  }
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32_MESSAGE(saves / STORE_SLOTS + 1, maxWrites, "writes spread over all slots");
+}
+
+// A save cut short leaves a record that fails its CRC
+void test_damaged_record_falls_back_to_the_one_before() {
+  settings.reportMinInterval = 1;
+  TEST_ASSERT_TRUE(saveConfigToEEPROM());
+  settings.reportMinInterval = 2;
+  TEST_ASSERT_TRUE(saveConfigToEEPROM());
+
+  int newest = newestSlot();
+  nativeStore()[newest * STORE_SLOT_SIZE + sizeof(StoreHeader) + offsetof(JoystickConfig, throttle)] ^= 0x01;
+  forgetConfig();
+  TEST_ASSERT_TRUE(loadConfigFromEEPROM());
+  TEST_ASSERT_EQUAL_UINT16(1, settings.reportMinInterval);
+
+  settings.reportMinInterval = 7;
+  TEST_ASSERT_TRUE(saveConfigToEEPROM());
+  TEST_ASSERT_EQUAL_INT_MESSAGE(newest, newestSlot(), "next save replaces the damaged record");
+  forgetConfig();
+  TEST_ASSERT_TRUE(loadConfigFromEEPROM());
+  TEST_ASSERT_EQUAL_UINT16(7, settings.reportMinInterval);
+}
+
+// clear only drops the mappings
+void test_clear_keeps_settings() {
+  config.throttle = 9;
+  settings.calibration[0].min = 1100;
+  settings.filterCutoff[2] = 33;
+  settings.failsafeTimeout = 500;
+  generateClearConfig();
+  TEST_ASSERT_EQUAL_UINT8(0, config.throttle);
+  TEST_ASSERT_EQUAL_UINT16(1100, settings.calibration[0].min);
+  TEST_ASSERT_EQUAL_UINT8(33, settings.filterCutoff[2]);
+  TEST_ASSERT_EQUAL_UINT16(500, settings.failsafeTimeout);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_erased_store_does_not_load);
+  RUN_TEST(test_old_layout_migrates);
+  RUN_TEST(test_saves_rotate_across_the_sequence_wrap);
+  RUN_TEST(test_damaged_record_falls_back_to_the_one_before);
+  RUN_TEST(test_clear_keeps_settings);
+  return UNITY_END();
+}
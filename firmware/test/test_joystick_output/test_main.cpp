@@ -0,0 +1,79 @@
+// HID report rate limit (joystick_output.cpp): feeds frames faster than the
+// minimum report interval and checks that every frame lands in exactly one
+// of the report counters.
+#include <unity.h>
+#include "joystick_output.h"
+#include "config.h"
+#include "rc_input.h"
+#include "hal_native.h"
+
+static ReportStats before;
+
+// Counters moved since setUp()
+static ReportStats moved() {
+  ReportStats now = getReportStats();
+  ReportStats d;
+  d.sent = now.sent - before.sent;
+  d.replaced = now.replaced - before.replaced;
+  d.unchanged = now.unchanged - before.unchanged;
+  d.keepAlive = now.keepAlive - before.keepAlive;
+  return d;
+}
+
+// One frame with every channel at value, ms after the previous one
+static void frame(uint16_t value, uint32_t ms) {
+  nativeAdvanceMicros(ms * 1000);
+  for (uint8_t i = 0; i < 16; i++) channelData[i] = value;
+  updateJoystickFromChannels();
+}
+
+void setUp() {
+  generateDefaultConfig();
+  generateDefaultSettings();
+  settings.reportMinInterval = 10;
+  settings.reportKeepAlive = 0;
+  beginJoystick();
+  frame(1500, 100); // Centred sticks differ from the all-zero start report
+  nativeAdvanceMicros(100000);
+  serviceHidReport();
+  before = getReportStats();
+}
+
+void tearDown() {
+}
+
+// A change held back by the interval, then a frame that goes back to what
+// was last sent: the held change is replaced and the new frame is unchanged
+void test_change_overtaken_by_unchanged_frame() {
+  frame(1600, 1); // Sent, the interval has long passed
+  frame(1700, 1);
+  frame(1600, 1);
+  ReportStats d = moved();
+  TEST_ASSERT_EQUAL_UINT32(1, d.sent);
+  TEST_ASSERT_EQUAL_UINT32(1, d.replaced);
+  TEST_ASSERT_EQUAL_UINT32(1, d.unchanged);
+}
+
+// Every frame is sent, replaced or unchanged, once
+void test_each_frame_counted_once() {
+  static const uint16_t values[] = {1500, 1600, 1600, 1500, 1700, 1700, 1700, 1800, 1500, 1500};
+  uint32_t frames = 0;
+  for (uint8_t round = 0; round < 20; round++) {
+    for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+      frame(values[i], 1 + (i + round) % 4);
+      frames++;
+    }
+  }
+  nativeAdvanceMicros(100000);
+  serviceHidReport(); // Sends a change still held back
+  ReportStats d = moved();
+  TEST_ASSERT_EQUAL_UINT32(frames, d.sent + d.replaced + d.unchanged);
+  TEST_ASSERT_EQUAL_UINT32(0, d.keepAlive);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_change_overtaken_by_unchanged_frame);
+  RUN_TEST(test_each_frame_counted_once);
+  return UNITY_END();
+}
@@ -0,0 +1,485 @@
+// RC input (rc_input.cpp): the CRSF decoder on a fixed byte stream and its
+// CRC against the published check value, the fixed-point range conversions
+// against Arduino's map(), both PPM engines on a train with known pulse
+// widths and across a dropout, and protocol auto detection on the streams
+// the simavr benchmarks play.
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include <unity.h>
+#include "config.h"
+#include "hal.h"
+#include "hal_native.h"
+#include "joystick_output.h"
+#include "rc_input.h"
+
+// The stream builders of bench/run_detect.sh, so detection is timed on the
+// same streams as under simavr
+#include "../../bench/bench_streams.cpp"
+
+void setUp() {
+  nativeStoreErase();
+  generateDefaultConfig();
+}
+
+void tearDown() {
+  endRcInput();
+}
+
+// --- CRSF ---
+
+// CRSF frames laid out per the protocol spec, sync 0xC8, length,
+// type, payload, CRC8 over type and payload
+static const uint8_t crsfChannelsA[] = {  // 992 992 172 992 1811 172 992 992, 992 for the rest
+  0xC8, 0x18, 0x16, 0xE0, 0x03, 0x1F, 0x2B, 0xC0, 0x37, 0x71, 0x56, 0x80, 0x0F, 0x7C,
+  0xE0, 0x03, 0x1F, 0xF8, 0xC0, 0x07, 0x3E, 0xF0, 0x81, 0x0F, 0x7C, 0xF6,
+};
+static const uint8_t crsfChannelsB[] = {  // 1811 172 992 1400 992 992 1811 172, 992 for the rest
+  0xC8, 0x18, 0x16, 0x13, 0x67, 0x05, 0xF8, 0xF0, 0x0A, 0x3E, 0xF0, 0x4D, 0x9C, 0x15,
+  0xE0, 0x03, 0x1F, 0xF8, 0xC0, 0x07, 0x3E, 0xF0, 0x81, 0x0F, 0x7C, 0x09,
+};
+static const uint8_t crsfChannelsBadCrc[] = {  // crsfChannelsB with one payload bit flipped
+  0xC8, 0x18, 0x16, 0x13, 0x67, 0x05, 0xF8, 0xF0, 0x0A, 0x3E, 0xF4, 0x4D, 0x9C, 0x15,
+  0xE0, 0x03, 0x1F, 0xF8, 0xC0, 0x07, 0x3E, 0xF0, 0x81, 0x0F, 0x7C, 0x09,
+};
+static const uint8_t crsfLinkStatistics[] = {  // 0x14, RSSI, LQ, SNR, RF mode and power
+  0xC8, 0x0C, 0x14, 0x32, 0x00, 0x64, 0x0B, 0x00, 0x04, 0x02, 0x2E, 0x64, 0x09, 0x87,
+};
+static const uint8_t crsfBattery[] = {  // 0x08, 15.4 V, 1.2 A, 300 mAh, 85 %
+  0xC8, 0x0A, 0x08, 0x00, 0x9A, 0x00, 0x0C, 0x00, 0x01, 0x2C, 0x55, 0x23,
+};
+static const uint8_t crsfDeviceInfo[] = {  // 0x29, extended header with destination and origin
+  0xC8, 0x15, 0x29, 0xEA, 0xEE, 0x52, 0x58, 0x00, 0x45, 0x4C, 0x52, 0x53, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x03, 0x04, 0x00, 0x0C, 0x00, 0x95,
+};
+
+static const uint16_t crsfExpectA[16] = {
+  1500, 1500, 1000, 1500, 2000, 1000, 1500, 1500, 1500, 1500, 1500, 1500, 1500, 1500, 1500, 1500,
+};
+static const uint16_t crsfExpectB[16] = {
+  2000, 1000, 1500, 1749, 1500, 1500, 2000, 1000, 1500, 1500, 1500, 1500, 1500, 1500, 1500, 1500,
+};
+
+// Sends one frame at 420000 baud, then the gap to the next one. True if the
+// decoder published a frame.
+static bool feedCrsf(const uint8_t *frame, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    nativeAdvanceMicros(24);
+    nativeSerialByte(frame[i]);
+  }
+  nativeAdvanceMicros(4000);
+  return readRawProtocol();
+}
+
+void test_crsf_channels_and_telemetry() {
+  config.protocol = CRSF;
+  beginRcInput();
+  RcLinkStats before;
+  readRcLinkStats(&before);
+
+  TEST_ASSERT_TRUE(feedCrsf(crsfChannelsA, sizeof(crsfChannelsA)));
+  TEST_ASSERT_EQUAL_UINT16_ARRAY(crsfExpectA, channelData, 16);
+  TEST_ASSERT_FALSE_MESSAGE(feedCrsf(crsfLinkStatistics, sizeof(crsfLinkStatistics)), "link statistics skipped");
+  TEST_ASSERT_FALSE_MESSAGE(feedCrsf(crsfBattery, sizeof(crsfBattery)), "battery skipped");
+  TEST_ASSERT_FALSE_MESSAGE(feedCrsf(crsfDeviceInfo, sizeof(crsfDeviceInfo)), "device info skipped");
+  TEST_ASSERT_TRUE_MESSAGE(feedCrsf(crsfChannelsB, sizeof(crsfChannelsB)), "channels after telemetry");
+  TEST_ASSERT_EQUAL_UINT16_ARRAY(crsfExpectB, channelData, 16);
+  TEST_ASSERT_FALSE_MESSAGE(feedCrsf(crsfChannelsBadCrc, sizeof(crsfChannelsBadCrc)), "broken CRC rejected");
+  TEST_ASSERT_EQUAL_UINT16_ARRAY(crsfExpectB, channelData, 16);
+  TEST_ASSERT_TRUE_MESSAGE(feedCrsf(crsfChannelsA, sizeof(crsfChannelsA)), "next good frame");
+  TEST_ASSERT_EQUAL_UINT16_ARRAY(crsfExpectA, channelData, 16);
+
+  // Telemetry is neither a frame nor an error
+  RcLinkStats after;
+  readRcLinkStats(&after);
+  TEST_ASSERT_EQUAL_UINT32(3, after.frames - before.frames);
+  TEST_ASSERT_EQUAL_UINT32(1, after.errors - before.errors);
+  TEST_ASSERT_EQUAL_UINT32(0, after.resyncs - before.resyncs);
+  TEST_ASSERT_EQUAL_UINT32(0, after.byteTimeouts - before.byteTimeouts);
+}
+
+// The frames above were built with the firmware's own CRC table, so a wrong
+// table would pass them. This checks the table against the published
+// CRC-8/DVB-S2 parameters instead: poly 0xD5, init 0, no reflection, check
+// value 0xBC for "123456789".
+static uint8_t crc8Bitwise(const uint8_t *data, size_t length) {
+  uint8_t crc = 0;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0xD5) : (uint8_t)(crc << 1);
+  }
+  return crc;
+}
+
+static uint8_t crc8Table(const uint8_t *data, size_t length) {
+  uint8_t crc = 0;
+  for (size_t i = 0; i < length; i++) crc = rcCrc8(crc, data[i]);
+  return crc;
+}
+
+void test_crc8_reference() {
+  static const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  TEST_ASSERT_EQUAL_HEX8(0xBC, crc8Bitwise(check, sizeof(check)));
+  TEST_ASSERT_EQUAL_HEX8(0xBC, crc8Table(check, sizeof(check)));
+
+  for (uint16_t byte = 0; byte < 256; byte++) {
+    uint8_t b = (uint8_t)byte;
+    TEST_ASSERT_EQUAL_HEX8(crc8Bitwise(&b, 1), rcCrc8(0, b));
+  }
+
+  // CRC over type and payload, i.e. everything after the length byte
+  static const uint8_t *const frames[] = {crsfChannelsA, crsfChannelsB, crsfLinkStatistics, crsfBattery, crsfDeviceInfo};
+  for (const uint8_t *frame : frames) {
+    uint8_t length = frame[1];
+    TEST_ASSERT_EQUAL_HEX8(frame[1 + length], crc8Bitwise(frame + 2, length - 1));
+  }
+}
+
+// --- Range conversions ---
+
+// Arduino's map(), as the decoders and the mapping used it before rcScale()
+static long arduinoMap(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// Every input of the range, returns how many differ from map()
+static long scaleMismatches(uint32_t mul, uint8_t shift, long inMin, long inMax,
+                            long outMin, long outMax, uint16_t offset) {
+  long mismatches = 0;
+  for (long x = inMin; x <= inMax; x++) {
+    long scaled = rcScale(x - offset, mul, shift) + outMin;
+    if (scaled != arduinoMap(x, inMin, inMax, outMin, outMax)) mismatches++;
+  }
+  return mismatches;
+}
+
+void test_scale_matches_map() {
+  TEST_ASSERT_EQUAL_MESSAGE(0, scaleMismatches(RC_SCALE_11BIT_MUL, RC_SCALE_11BIT_SHIFT, 172, 1811, 1000, 2000, 172),
+                            "SBUS/CRSF/FPORT");
+  TEST_ASSERT_EQUAL_MESSAGE(0, scaleMismatches(RC_SCALE_DSMX_MUL, RC_SCALE_DSMX_SHIFT, 0, 2047, 1000, 2000, 0), "DSMX");
+  TEST_ASSERT_EQUAL_MESSAGE(0, scaleMismatches(RC_SCALE_DSM2_MUL, RC_SCALE_DSM2_SHIFT, 0, 1023, 1000, 2000, 0), "DSM2");
+  TEST_ASSERT_EQUAL_MESSAGE(0, scaleMismatches(RC_SCALE_AXIS_MUL, RC_SCALE_AXIS_SHIFT, 1000, 2000, 0, 1023, 1000), "axis");
+  TEST_ASSERT_EQUAL_MESSAGE(0, scaleMismatches(RC_SCALE_HAT_MUL, RC_SCALE_HAT_SHIFT, 1000, 2000, 0, 8, 1000), "hat");
+}
+
+// --- PPM ---
+
+#define PPM_TEST_FRAMES 200
+#define PPM_TEST_CHANNELS 8
+
+// Width of one channel in half us, 1000-2000us, different for every channel and frame
+static uint16_t ppmWidth(uint16_t frame, uint8_t channel) {
+  return 2000 + ((frame * 37UL + channel * 131UL) * 7) % 2001;
+}
+
+// One rising edge on whichever PPM input the protocol listens on
+static void ppmEdge(uint8_t protocol, uint32_t halfMicros) {
+  if (protocol == PPM) nativePPMEdge();
+  else nativeCaptureEdge(halfMicros * HAL_CAPTURE_TICKS_PER_US / 2);
+}
+
+// Plays PPM_TEST_FRAMES frames of 22.5ms, returns the largest decode error in
+// us, counts decoded and exact frames
+static uint16_t runPpmTrain(uint8_t protocol, uint16_t *decoded, uint16_t *exact) {
+  config.protocol = protocol;
+  beginRcInput();
+
+  uint32_t halfMicros = 0;
+  uint16_t maxError = 0;
+  *decoded = *exact = 0;
+  for (uint16_t frame = 0; frame < PPM_TEST_FRAMES; frame++) {
+    uint32_t frameHalfMicros = 45000;
+    for (uint8_t i = 0; i <= PPM_TEST_CHANNELS; i++) {
+      // Rising edges, the interval after the last channel is the sync gap
+      uint32_t interval = (i < PPM_TEST_CHANNELS) ? ppmWidth(frame, i) : frameHalfMicros;
+      frameHalfMicros -= interval;
+      halfMicros += interval;
+      nativeSetMicros(halfMicros / 2);
+      ppmEdge(protocol, interval);
+    }
+
+    if (!readRawProtocol()) continue;
+    (*decoded)++;
+    bool same = true;
+    for (uint8_t i = 0; i < PPM_TEST_CHANNELS; i++) {
+      uint16_t sent = (ppmWidth(frame, i) + 1) / 2; // Rounded to the nearest us
+      uint16_t error = (channelData[i] > sent) ? channelData[i] - sent : sent - channelData[i];
+      if (error > maxError) maxError = error;
+      same &= (error == 0);
+    }
+    if (same) (*exact)++;
+  }
+  return maxError;
+}
+
+// halMicros() only has 1us steps here, the real pin 0 engine sees 4us steps
+// plus the interrupt latency
+void test_ppm_pin0_within_clock_resolution() {
+  uint16_t decoded, exact;
+  uint16_t error = runPpmTrain(PPM, &decoded, &exact);
+  TEST_ASSERT_EQUAL_UINT16(PPM_TEST_FRAMES, decoded);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT16(1, error);
+}
+
+// Waits for the first sync gap, so one frame fewer
+void test_ppm_capture_exact() {
+  uint16_t decoded, exact;
+  runPpmTrain(PPM_CAPTURE, &decoded, &exact);
+  TEST_ASSERT_EQUAL_UINT16(PPM_TEST_FRAMES - 1, decoded);
+  TEST_ASSERT_EQUAL_UINT16(decoded, exact);
+}
+
+// One interval between two rising edges, in whole us
+static void ppmInterval(uint8_t protocol, uint32_t micros) {
+  nativeAdvanceMicros(micros);
+  ppmEdge(protocol, micros * 2);
+}
+
+// Channels first to last - 1 of a frame, whole us
+static void ppmChannels(uint8_t protocol, uint16_t frame, uint8_t first, uint8_t last) {
+  for (uint8_t i = first; i < last; i++) ppmInterval(protocol, (ppmWidth(frame, i) + 1) / 2);
+}
+
+// The line drops out for 200ms in the middle of a frame and comes back in
+// the middle of another. Neither partial frame may be published, shifted
+// into a frame of its own, and the next whole frame decodes in place.
+static void checkGapInFrame(uint8_t protocol) {
+  config.protocol = protocol;
+  beginRcInput();
+  for (uint16_t frame = 0; frame < 10; frame++) {
+    ppmChannels(protocol, frame, 0, PPM_TEST_CHANNELS);
+    ppmInterval(protocol, 8000);
+    readRawProtocol();
+  }
+
+  ppmChannels(protocol, 10, 0, 3);
+  ppmInterval(protocol, 200000);
+  ppmChannels(protocol, 11, 4, PPM_TEST_CHANNELS);
+  ppmInterval(protocol, 8000);
+  TEST_ASSERT_FALSE_MESSAGE(readRawProtocol(), "partial frames around the gap published");
+
+  ppmChannels(protocol, 12, 0, PPM_TEST_CHANNELS);
+  ppmInterval(protocol, 8000);
+  TEST_ASSERT_TRUE_MESSAGE(readRawProtocol(), "next whole frame decodes");
+  for (uint8_t i = 0; i < PPM_TEST_CHANNELS; i++) {
+    TEST_ASSERT_EQUAL_UINT16((ppmWidth(12, i) + 1) / 2, channelData[i]);
+  }
+}
+
+void test_ppm_pin0_gap_in_frame() {
+  checkGapInFrame(PPM);
+}
+
+void test_ppm_capture_gap_in_frame() {
+  checkGapInFrame(PPM_CAPTURE);
+}
+
+// The loop running with no edges coming in, in 1ms steps
+static void dropoutIdle(uint32_t ms) {
+  for (uint32_t i = 0; i < ms; i++) {
+    nativeAdvanceMicros(1000);
+    nativeTick();
+    serviceFailsafe();
+    readProtocol();
+  }
+}
+
+// One 22.5ms frame of the PPM train, true if the loop got a frame out of it
+static bool dropoutFrame(uint8_t protocol, uint16_t frame) {
+  bool decoded = false;
+  uint32_t left = 22500;
+  for (uint8_t i = 0; i <= PPM_TEST_CHANNELS; i++) {
+    uint32_t interval = (i < PPM_TEST_CHANNELS) ? (ppmWidth(frame, i) + 1) / 2 : left;
+    left -= interval;
+    nativeAdvanceMicros(interval);
+    nativeTick();
+    serviceFailsafe();
+    ppmEdge(protocol, interval * 2);
+    if (readProtocol()) decoded = true;
+  }
+  return decoded;
+}
+
+// The train stops for 200ms: the failsafe engages during the gap only, and
+// frames decode again once the train is back
+static void checkDropout(uint8_t protocol) {
+  config.protocol = protocol;
+  beginJoystick();
+  beginRcInput();
+
+  uint16_t before = 0, after = 0;
+  for (uint16_t frame = 0; frame < 20; frame++) before += dropoutFrame(protocol, frame);
+  TEST_ASSERT_FALSE_MESSAGE(failsafeActive(), "no failsafe before the gap");
+  dropoutIdle(200);
+  TEST_ASSERT_TRUE_MESSAGE(failsafeActive(), "failsafe during the gap");
+  for (uint16_t frame = 20; frame < 40; frame++) after += dropoutFrame(protocol, frame);
+  TEST_ASSERT_FALSE_MESSAGE(failsafeActive(), "failsafe cleared after the gap");
+
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT16(19, before);
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT16(19, after);
+  TEST_ASSERT_EQUAL_UINT16((ppmWidth(39, 0) + 1) / 2, channelData[0]);
+}
+
+void test_ppm_pin0_dropout() {
+  checkDropout(PPM);
+}
+
+void test_ppm_capture_dropout() {
+  checkDropout(PPM_CAPTURE);
+}
+
+// --- Auto detection ---
+
+#define DETECT_RUNS 10
+#define DETECT_TIMEOUT_MS (3 * AUTO_CYCLE_MS)
+#define DETECT_LOOP_MICROS 100   // The loop polls at least this often
+
+// How the protocol's receiver UART is set up, as in halSerialBegin()
+static void detectWire(uint8_t protocol, uint32_t *baud, uint8_t *format) {
+  *baud = (protocol == SBUS) ? 100000 : (protocol == CRSF) ? 420000 : 115200;
+  *format = (protocol == SBUS) ? HAL_SERIAL_8E2 : HAL_SERIAL_8N1;
+}
+
+// Runs the loop up to the given time, with the millisecond tick
+static void detectLoopUntil(uint32_t micros) {
+  while ((int32_t)(micros - halMicros()) > 0) {
+    uint32_t step = std::min<uint32_t>(micros - halMicros(), DETECT_LOOP_MICROS);
+    uint32_t ms = halMillis();
+    nativeAdvanceMicros(step);
+    if (halMillis() != ms) nativeTick();
+    readProtocol();
+  }
+}
+
+struct DetectLock {
+  uint32_t micros;   // From the first byte or edge of the stream to the lock
+  uint32_t frames;   // Frames completed on the wire by then
+};
+
+// Plays the stream from the current time until detection locks. Like
+// bench/simdetect.cpp, bytes only get through while the UART runs at the
+// stream's baud rate and framing, otherwise it makes random bytes of the
+// line at its own rate, and PPM edges only reach the pin the stream is wired
+// to. False on a timeout.
+static bool detectPlay(const BenchProtocol &protocol, DetectLock *lock) {
+  static uint32_t seed = 0x2545F491;
+  std::vector<BenchEvent> events;
+  buildStream(protocol, DETECT_TIMEOUT_MS * 1000 / protocol.framePeriodUs + 1, &events);
+  uint32_t baud;
+  uint8_t format;
+  detectWire(protocol.id, &baud, &format);
+
+  uint32_t start = halMicros();
+  uint32_t nextNoise = start;
+  uint32_t lastRise = start;
+  lock->frames = 0;
+  for (const BenchEvent &event : events) {
+    uint32_t at = start + (uint32_t)(event.timeNs / 1000);
+    detectLoopUntil(at);
+    if (rcInputProtocol()) {
+      lock->micros = halMicros() - start;
+      return true;
+    }
+
+    if (event.kind == BENCH_EVENT_BYTE) {
+      if (nativeSerialBaud() == baud && nativeSerialFormat() == format) {
+        nativeSerialByte(event.value);
+      } else if (nativeSerialRunning() && (int32_t)(at - nextNoise) >= 0) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        nativeSerialByte(seed & 0xFF);
+        nextNoise = at + nativeSerialByteMicros();
+      }
+    } else if (event.value) {
+      if (protocol.id == PPM) nativePPMEdge();
+      if (protocol.id == PPM_CAPTURE) nativeCaptureEdge((at - lastRise) * HAL_CAPTURE_TICKS_PER_US);
+      lastRise = at;
+    }
+    if (event.frameEnd) lock->frames++;
+  }
+  return false;
+}
+
+static uint32_t median(std::vector<uint32_t> values) {
+  std::sort(values.begin(), values.end());
+  return values[values.size() / 2];
+}
+
+// Boots DETECT_RUNS times, each time starting the stream at another point of
+// the candidate cycle, and times the lock at boot and again after a signal
+// loss. Every lock has to be the right protocol within AUTO_CYCLE_MS plus
+// AUTO_LOCK_FRAMES + 1 frame periods.
+static void checkDetect(const char *name) {
+  const BenchProtocol *protocol = benchProtocols;
+  while (protocol->name && strcmp(protocol->name, name) != 0) protocol++;
+  TEST_ASSERT_NOT_NULL(protocol->name);
+  uint32_t boundMicros = AUTO_CYCLE_MS * 1000UL + (AUTO_LOCK_FRAMES + 1) * protocol->framePeriodUs;
+
+  std::vector<uint32_t> frames[2], micros[2];   // At boot, after a loss
+  config.protocol = AUTO;
+  for (int run = 0; run < DETECT_RUNS; run++) {
+    beginRcInput(); // Boot
+    detectLoopUntil(halMicros() + run * AUTO_CYCLE_MS * 1000UL / DETECT_RUNS + 137);
+    for (int pass = 0; pass < 2; pass++) {
+      DetectLock lock;
+      TEST_ASSERT_TRUE_MESSAGE(detectPlay(*protocol, &lock), "no lock");
+      TEST_ASSERT_EQUAL_UINT8_MESSAGE(protocol->id, rcInputProtocol(), "locked onto another protocol");
+      TEST_ASSERT_LESS_OR_EQUAL_UINT32_MESSAGE(boundMicros, lock.micros, "lock slower than the bound");
+      frames[pass].push_back(lock.frames);
+      micros[pass].push_back(lock.micros);
+
+      // Signal lost, detection lets go
+      detectLoopUntil(halMicros() + (AUTO_RELOCK_MS + 10) * 1000UL);
+      TEST_ASSERT_EQUAL_UINT8_MESSAGE(0, rcInputProtocol(), "still locked after the signal stopped");
+    }
+    endRcInput();
+  }
+
+  // Frames on the wire and simulated ms, min/median/max
+  char message[160];
+  int length = snprintf(message, sizeof(message), "%s:", name);
+  for (int pass = 0; pass < 2; pass++) {
+    std::vector<uint32_t> &f = frames[pass], &us = micros[pass];
+    length += snprintf(message + length, sizeof(message) - length, " %s %lu/%lu/%lu frames (%lu/%lu/%lu ms),",
+                       pass ? "relock" : "lock",
+                       (unsigned long)*std::min_element(f.begin(), f.end()), (unsigned long)median(f),
+                       (unsigned long)*std::max_element(f.begin(), f.end()),
+                       (unsigned long)*std::min_element(us.begin(), us.end()) / 1000,
+                       (unsigned long)median(us) / 1000, (unsigned long)*std::max_element(us.begin(), us.end()) / 1000);
+  }
+  snprintf(message + length, sizeof(message) - length, " bound %lu ms", (unsigned long)boundMicros / 1000);
+  TEST_MESSAGE(message);
+}
+
+void test_auto_detects_ibus() { checkDetect("ibus"); }
+void test_auto_detects_sbus() { checkDetect("sbus"); }
+void test_auto_detects_crsf() { checkDetect("crsf"); }
+void test_auto_detects_dsmx() { checkDetect("dsmx"); }
+void test_auto_detects_dsm2() { checkDetect("dsm2"); }
+void test_auto_detects_fport() { checkDetect("fport"); }
+void test_auto_detects_ppm() { checkDetect("ppm"); }
+void test_auto_detects_ppm_capture() { checkDetect("ppm_icp"); }
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_crsf_channels_and_telemetry);
+  RUN_TEST(test_crc8_reference);
+  RUN_TEST(test_scale_matches_map);
+  RUN_TEST(test_ppm_pin0_within_clock_resolution);
+  RUN_TEST(test_ppm_capture_exact);
+  RUN_TEST(test_ppm_pin0_gap_in_frame);
+  RUN_TEST(test_ppm_capture_gap_in_frame);
+  RUN_TEST(test_ppm_pin0_dropout);
+  RUN_TEST(test_ppm_capture_dropout);
+  RUN_TEST(test_auto_detects_ibus);
+  RUN_TEST(test_auto_detects_sbus);
+  RUN_TEST(test_auto_detects_crsf);
+  RUN_TEST(test_auto_detects_dsmx);
+  RUN_TEST(test_auto_detects_dsm2);
+  RUN_TEST(test_auto_detects_fport);
+  RUN_TEST(test_auto_detects_ppm);
+  RUN_TEST(test_auto_detects_ppm_capture);
+  return UNITY_END();
+}
@@ -0,0 +1,51 @@
+// Status LED effects (status_led.cpp) over simulated time, counting how often
+// the colour is pushed to the LED.
+#include <unity.h>
+#include "status_led.h"
+#include "hal_native.h"
+
+// Calls updateLED() once per ms, returns the number of halLedShow() calls
+static uint32_t runLED(uint32_t ms) {
+  uint32_t shows = nativeLedShows();
+  for (uint32_t i = 0; i < ms; i++) {
+    nativeAdvanceMicros(1000);
+    updateLED();
+  }
+  return nativeLedShows() - shows;
+}
+
+void setUp() {
+  setLED(0, 0, 0);
+  runLED(1000);
+}
+
+void tearDown() {
+}
+
+// Two flashes are four 100 ms steps, on, off, on, off
+void test_flash_pushes_every_step() {
+  startFlashLED(255, 0, 0, 2);
+  TEST_ASSERT_EQUAL_UINT32(4, runLED(1000));
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, runLED(1000), "nothing pushed once the flash is over");
+}
+
+// The pulse steps every 20 ms and every step changes the colour
+void test_pulse_pushes_every_step() {
+  startPulseLED(0, 0, 255);
+  uint32_t shows = runLED(1000);
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(45, shows);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(50, shows);
+}
+
+void test_solid_colour_pushed_once() {
+  setLED(0, 255, 0);
+  TEST_ASSERT_EQUAL_UINT32(0, runLED(1000));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_flash_pushes_every_step);
+  RUN_TEST(test_pulse_pushes_every_step);
+  RUN_TEST(test_solid_colour_pushed_once);
+  return UNITY_END();
+}
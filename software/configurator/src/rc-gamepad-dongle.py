@@ -2,14 +2,362 @@
 import sys
 import json
 import os
+import time
+from collections import deque
 from PySide6.QtWidgets import (
     QApplication, QMainWindow, QWidget, QVBoxLayout, QHBoxLayout,
     QComboBox, QPushButton, QLabel, QTextEdit, QTabWidget, QScrollArea,
     QGridLayout, QFormLayout, QFileDialog, QMessageBox, QFrame
 )
 from PySide6.QtSerialPort import QSerialPort, QSerialPortInfo
-from PySide6.QtCore import QIODevice, Slot, Qt
-from PySide6.QtGui import QIcon
+from PySide6.QtCore import QIODevice, QObject, Slot, Qt, QTimer
+from PySide6.QtGui import QIcon, QPainter, QColor, QPen
+
+# Binary frames, see firmware/include/serial_frame.h
+SERIAL_FRAME_MONITOR = 0x01
+SERIAL_FRAME_CONFIG = 0x02
+
+# Live monitor stream, see firmware/include/monitor.h
+MONITOR_PAYLOAD_SIZE = 38  # Without the CRC
+MONITOR_HISTORY = 400  # Samples kept per channel for the plot
+
+# Config image for 'get'/'put', see firmware/include/config.h
+CONFIG_IMAGE_VERSION = 1
+CONFIG_FIELDS = (["protocol", "x_axis", "y_axis", "z_axis", "rx_axis", "ry_axis", "rz_axis",
+                  "rudder", "throttle", "accelerator", "brake", "steering"] +
+                 [f"button_{i}" for i in range(1, 33)] +
+                 ["hat_switch_1", "hat_switch_2"])  # JoystickConfig field order
+PROTOCOL_IDS = {"ibus": 1, "sbus": 2, "crsf": 3, "dsmx": 4, "dsm2": 5, "fport": 6, "ppm": 7, "ppm_icp": 8, "auto": 9}
+
+
+def cobs_encode(data):
+    """COBS encodes data and appends the 0x00 delimiter (payloads under 254 bytes)."""
+    out = bytearray([0])
+    code = 0
+    for byte in data:
+        if byte == 0:
+            out[code] = len(out) - code
+            code = len(out)
+            out.append(0)
+        else:
+            out.append(byte)
+    out[code] = len(out) - code
+    out.append(0)
+    return bytes(out)
+
+
+def cobs_decode(data):
+    """Decodes one COBS block (without the 0x00 delimiter). Returns None if malformed."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def crc8_dvb_s2(data):
+    """CRC8 with poly 0xD5, the check CRSF and the monitor stream use."""
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0xD5) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def encode_serial_frame(payload):
+    """Appends the CRC8 and COBS encodes, ready to write to the dongle."""
+    return cobs_encode(bytes(payload) + bytes([crc8_dvb_s2(payload)]))
+
+
+def decode_serial_frame(block):
+    """Decodes one frame (without its 0x00) and checks the CRC. Returns the payload or None."""
+    data = cobs_decode(block)
+    if data is None or len(data) < 2 or crc8_dvb_s2(data[:-1]) != data[-1]:
+        return None
+    return data[:-1]
+
+
+def parse_monitor_frame(block):
+    """Returns (sequence, link_frames, link_errors, channels) or None if the block is not a valid frame."""
+    payload = decode_serial_frame(block)
+    if payload is None or len(payload) != MONITOR_PAYLOAD_SIZE or payload[0] != SERIAL_FRAME_MONITOR:
+        return None
+    channels = [payload[6 + 2 * i] | (payload[7 + 2 * i] << 8) for i in range(16)]
+    return payload[1], payload[2] | (payload[3] << 8), payload[4] | (payload[5] << 8), channels
+
+
+class ChannelPlot(QWidget):
+    """Strip chart of the 16 channels, one row each, newest sample on the right."""
+
+    def __init__(self, parent=None):
+        super().__init__(parent)
+        self.history = [deque(maxlen=MONITOR_HISTORY) for _ in range(16)]
+        self.setMinimumHeight(16 * 22)
+
+    def add_sample(self, channels):
+        for history, value in zip(self.history, channels):
+            history.append(value)
+
+    def clear(self):
+        for history in self.history:
+            history.clear()
+        self.update()
+
+    def paintEvent(self, event):
+        painter = QPainter(self)
+        painter.fillRect(self.rect(), QColor(35, 35, 35))
+        label_width = 90
+        row_height = self.height() / 16
+        plot_width = max(1, self.width() - label_width - 4)
+
+        for ch, history in enumerate(self.history):
+            top = ch * row_height
+            # 1000-2000us fills the row, centre line at 1500
+            painter.setPen(QPen(QColor(70, 70, 70)))
+            painter.drawLine(label_width, int(top + row_height / 2), self.width(), int(top + row_height / 2))
+            painter.setPen(Qt.white)
+            value = history[-1] if history else 0
+            painter.drawText(4, int(top), label_width, int(row_height), Qt.AlignVCenter,
+                             f"CH{ch + 1}: {value}" if history else f"CH{ch + 1}: --")
+            if len(history) < 2:
+                continue
+            painter.setPen(QPen(QColor(42, 130, 218), 1.5))
+            step = plot_width / (MONITOR_HISTORY - 1)
+            x0 = label_width + plot_width - (len(history) - 1) * step
+            prev = None
+            for i, v in enumerate(history):
+                v = min(max(v, 1000), 2000)
+                point = (x0 + i * step, top + row_height - 2 - (v - 1000) / 1000 * (row_height - 4))
+                if prev:
+                    painter.drawLine(int(prev[0]), int(prev[1]), int(point[0]), int(point[1]))
+                prev = point
+        painter.end()
+
+
+# --- Serial transport ---
+
+def until_line(*prefixes):
+    """Response is complete at the first full line starting with one of the prefixes."""
+    def done(text):
+        for line_start, line in _complete_lines(text):
+            if line.startswith(prefixes):
+                return text.find(b"\n", line_start) + 1
+        return -1
+    return done
+
+
+def until_exact_line(expected):
+    """Response is complete at the first full line that is exactly expected."""
+    def done(text):
+        for line_start, line in _complete_lines(text):
+            if line == expected:
+                return text.find(b"\n", line_start) + 1
+        return -1
+    return done
+
+
+def _complete_lines(data):
+    """Yields (offset, stripped text) for every line that already ends in a newline."""
+    start = 0
+    while True:
+        end = data.find(b"\n", start)
+        if end == -1:
+            return
+        yield start, data[start:end].decode('utf-8', 'ignore').strip()
+        start = end + 1
+
+
+# Where the dongle's reply to each command ends
+SET_DONE = until_line("Configuration updated", "No changes made", "Usage:", "ERROR: Invalid",
+                      "ERROR: Unknown control", "Type 'help'")
+SAVE_DONE = until_line("Configuration saved", "ERROR:")
+TEST_DONE = until_line("TEST:", "Type 'help'")
+CONFIG_DONE = until_exact_line("=============================")
+PUT_DONE = until_line("PUT:", "ERROR: Invalid", "Type 'help'")
+MONITOR_DONE = until_line("MONITOR: started", "Type 'help'")
+
+
+def get_done(data):
+    """'get' ends with the binary frame after its marker line."""
+    marker = data.find(b"GET: binary config follows")
+    if marker == -1:
+        return until_line("Type 'help'")(data)
+    frame_end = data.find(b"\x00", marker)
+    if frame_end == -1:
+        return -1
+    line_end = data.find(b"\n", frame_end)
+    return line_end + 1 if line_end != -1 else -1
+
+
+class SerialRequest:
+    def __init__(self, command, payload, done, on_done, timeout_ms):
+        self.command = command
+        self.payload = payload
+        self.done = done
+        self.on_done = on_done
+        self.timeout_ms = timeout_ms
+        self.sent_at = None
+
+
+class DongleLink(QObject):
+    """Asynchronous command transport to the dongle.
+
+    Commands are queued and written ahead of the replies, up to MAX_IN_FLIGHT
+    at a time. The dongle handles them strictly in order and starts every
+    reply by echoing 'RX: <command>', so each reply is matched to its request
+    by that echo and ends where the request's done() says. Nothing here
+    blocks; replies arrive through readyRead and are handed to each request's
+    on_done(response, ok, rtt_ms) callback.
+    """
+
+    MAX_IN_FLIGHT = 8
+    IDLE_MS = 100          # Replies without a done() end after this much silence
+
+    def __init__(self, serial, log, parent=None):
+        super().__init__(parent)
+        self.serial = serial
+        self.log = log
+        self.queue = deque()     # Not written yet
+        self.in_flight = deque()  # Written, reply not complete
+        self.buffer = bytearray()
+        self.raw_handler = None  # Takes every received byte instead of the matcher (monitor stream)
+        self.rtts = []
+        self.serial.readyRead.connect(self.on_ready_read)
+
+        self.idle_timer = QTimer(self)
+        self.idle_timer.setSingleShot(True)
+        self.idle_timer.timeout.connect(self.on_idle)
+        self.timeout_timer = QTimer(self)
+        self.timeout_timer.setInterval(50)
+        self.timeout_timer.timeout.connect(self.check_timeouts)
+
+    def send(self, command, on_done=None, done=None, payload=b"", timeout_ms=2000):
+        """Queues a command. payload is written right after the command line (binary 'put')."""
+        self.queue.append(SerialRequest(command, payload, done, on_done, timeout_ms))
+        self.pump()
+
+    def write_raw(self, data):
+        """Writes bytes outside the request queue."""
+        self.serial.write(data)
+
+    def set_raw_handler(self, handler):
+        self.raw_handler = handler
+        if handler and self.buffer:
+            data = bytes(self.buffer)
+            self.buffer.clear()
+            handler(data)
+
+    def busy(self):
+        return bool(self.queue or self.in_flight)
+
+    def reset(self):
+        """Forgets every pending request, e.g. when the port is closed."""
+        self.queue.clear()
+        self.in_flight.clear()
+        self.buffer.clear()
+        self.raw_handler = None
+        self.idle_timer.stop()
+        self.timeout_timer.stop()
+
+    def begin_batch(self):
+        self.rtts = []
+
+    def batch_summary(self):
+        """One line with the round-trip times measured since begin_batch()."""
+        if not self.rtts:
+            return "no replies"
+        rtts = sorted(self.rtts)
+        return (f"{len(rtts)} commands, RTT min {rtts[0]:.1f} ms / median {rtts[len(rtts) // 2]:.1f} ms"
+                f" / max {rtts[-1]:.1f} ms")
+
+    def pump(self):
+        while self.queue and len(self.in_flight) < self.MAX_IN_FLIGHT:
+            request = self.queue.popleft()
+            request.sent_at = time.perf_counter()
+            self.in_flight.append(request)
+            self.log(f"CMD >> {request.command}" + (f" (+{len(request.payload)} bytes)" if request.payload else ""))
+            self.serial.write(f"{request.command}\n".encode('utf-8') + request.payload)
+        if self.in_flight:
+            self.timeout_timer.start()
+
+    @Slot()
+    def on_ready_read(self):
+        data = self.serial.readAll().data()
+        if self.raw_handler:
+            self.raw_handler(data)
+            return
+        self.buffer += data
+        self.idle_timer.start(self.IDLE_MS)
+        self.match()
+
+    def match(self):
+        while self.in_flight and not self.raw_handler:
+            request = self.in_flight[0]
+            echo = f"RX: {request.command}".encode('utf-8')
+
+            # Skip anything before this request's echo (stray output, replies to garbage)
+            start = -1
+            for line_start, line in _complete_lines(self.buffer):
+                if line.encode('utf-8') == echo:
+                    start = line_start
+                    break
+            if start == -1:
+                return
+            if start > 0:
+                del self.buffer[:start]
+
+            reply_start = self.buffer.find(b"\n") + 1
+            if request.done:
+                end = request.done(bytes(self.buffer[reply_start:]))
+                if end == -1:
+                    return
+                end += reply_start
+            else:
+                # Ends at the next echo, or on silence (on_idle)
+                end = self.buffer.find(b"RX: ", reply_start)
+                if end == -1:
+                    return
+            self.complete(bytes(self.buffer[reply_start:end]), True)
+            del self.buffer[:end]
+
+    def complete(self, response, ok):
+        request = self.in_flight.popleft()
+        rtt = (time.perf_counter() - request.sent_at) * 1000
+        if ok:
+            self.rtts.append(rtt)
+        text = response.decode('utf-8', 'ignore').strip() if b"\x00" not in response else f"{len(response)} bytes"
+        self.log(f"RSP << {text} [{rtt:.1f} ms]" if ok else f"Timeout: no reply to '{request.command}' after {rtt:.0f} ms")
+        if not self.in_flight:
+            self.timeout_timer.stop()
+        self.pump()
+        if request.on_done:
+            request.on_done(response, ok, rtt)
+
+    @Slot()
+    def on_idle(self):
+        if self.in_flight and not self.in_flight[0].done and self.buffer.startswith(b"RX: "):
+            reply_start = self.buffer.find(b"\n") + 1
+            if reply_start > 0:
+                response = bytes(self.buffer[reply_start:])
+                self.buffer.clear()
+                self.complete(response, True)
+
+    @Slot()
+    def check_timeouts(self):
+        if not self.in_flight:
+            self.timeout_timer.stop()
+            return
+        request = self.in_flight[0]
+        if (time.perf_counter() - request.sent_at) * 1000 > request.timeout_ms:
+            self.complete(b"", False)
+
 
 class ConfiguratorApp(QMainWindow):
     def __init__(self):
@@ -39,6 +387,11 @@ class ConfiguratorApp(QMainWindow):
         # Serial port object
         self.serial = QSerialPort(self)
         self.serial.setBaudRate(115200) # From your Arduino code
+        self.link = DongleLink(self.serial, self.log, self)
+
+        # Live monitor state
+        self.monitor_state = None  # None, 'starting', 'streaming' or 'stopping'
+        self.monitor_buffer = bytearray()
 
         # --- Initialize UI sections ---
         self.initUI_Connection()
@@ -138,7 +491,7 @@ class ConfiguratorApp(QMainWindow):
         # Start with undefined protocol to enforce selection
         self.protocol_combo.addItem("-- Select Protocol --", None)
         # Updated protocol list to match Arduino dongle - set data for each item
-        protocols = ["ibus", "sbus", "crsf", "dsmx", "dsm2", "fport", "ppm"]
+        protocols = ["ibus", "sbus", "crsf", "dsmx", "dsm2", "fport", "ppm", "ppm_icp", "auto"]
         for protocol in protocols:
             self.protocol_combo.addItem(protocol, protocol)
         self.protocol_combo.addItem("Debug Mode", "debug") # Added debug mode
@@ -210,6 +563,28 @@ class ConfiguratorApp(QMainWindow):
             
         self.tabs.addTab(hats_tab, "Hat Switches")
 
+        # --- Monitor Tab ---
+        monitor_tab = QWidget()
+        monitor_layout = QVBoxLayout(monitor_tab)
+
+        monitor_bar = QHBoxLayout()
+        self.monitor_button = QPushButton("Start Monitor")
+        self.monitor_button.clicked.connect(self.toggle_monitor)
+        monitor_bar.addWidget(self.monitor_button)
+        self.monitor_status = QLabel("Stopped")
+        monitor_bar.addWidget(self.monitor_status, 1)
+        monitor_layout.addLayout(monitor_bar)
+
+        self.channel_plot = ChannelPlot()
+        monitor_layout.addWidget(self.channel_plot, 1)
+
+        self.monitor_tab_index = self.tabs.addTab(monitor_tab, "Monitor")
+
+        # Repaint at a fixed rate, independent of the receiver frame rate
+        self.monitor_timer = QTimer(self)
+        self.monitor_timer.setInterval(33)
+        self.monitor_timer.timeout.connect(self.refresh_monitor)
+
         self.main_layout.addWidget(self.tabs, 1) # Give tabs extra space
 
     def initUI_StatusLog(self):
@@ -287,7 +662,8 @@ class ConfiguratorApp(QMainWindow):
         
         # Enable/disable tabs (indices: 0=General, 1=Axes, 2=Buttons, 3=Hat Switches)
         for i in range(1, self.tabs.count()):  # Skip General tab (index 0)
-            self.tabs.setTabEnabled(i, protocol_selected)
+            if i != self.monitor_tab_index:  # Monitor shows whatever the dongle decodes
+                self.tabs.setTabEnabled(i, protocol_selected)
             
         # Enable/disable save buttons
         self.save_dongle_button.setEnabled(protocol_selected)
@@ -324,7 +700,7 @@ class ConfiguratorApp(QMainWindow):
     def open_serial_port(self):
         """Opens the selected serial port. Returns True on success, False on failure."""
         if self.serial.isOpen():
-            self.serial.close()
+            self.close_serial_port()
             
         port_name = self.port_combo.currentData()
         if not port_name:
@@ -342,135 +718,143 @@ class ConfiguratorApp(QMainWindow):
         self.log(f"Serial port {port_name} opened.")
         return True
 
-    def send_serial_command(self, command, read_timeout=500):
-        """Sends a command and returns the response."""
-        if not self.serial.isOpen():
-            self.log("Error: Serial port is not open.")
-            return ""
-            
-        self.log(f"CMD >> {command}")
-        self.serial.write(f"{command}\n".encode('utf-8'))
-        
-        if not self.serial.waitForBytesWritten(100):
-            self.log("Warning: Failed to write command to serial port.")
-            
-        # Wait for data to come back
-        response = ""
-        while self.serial.waitForReadyRead(read_timeout):
-            data = self.serial.readAll()
-            response += data.data().decode('utf-8', 'ignore')
-            read_timeout = 50 # Shorten timeout after first read
-            
-        self.log(f"RSP << {response.strip()}")
-        return response
+    def close_serial_port(self):
+        self.link.reset()
+        if self.serial.isOpen():
+            self.serial.close()
+
+    def set_busy(self, busy):
+        """Locks the dongle buttons while an operation owns the port."""
+        self.load_dongle_button.setEnabled(not busy)
+        self.save_dongle_button.setEnabled(not busy and self.protocol_combo.currentData() is not None)
+        self.monitor_button.setEnabled(not busy)
+
+    def finish_operation(self, message):
+        self.log(f"{message} ({self.link.batch_summary()})")
+        self.close_serial_port()
+        self.set_busy(False)
+
+    def apply_loaded_values(self, values):
+        """Selects the loaded protocol and channels in the UI. Returns the number of settings applied."""
+        applied = 0
+        for key, value in values.items():
+            combo_box = self.controls_map.get(key)
+            if combo_box is None:
+                continue
+            index = combo_box.findText(value) if key == 'protocol' else combo_box.findData(value)
+            if index == -1:
+                self.log(f"Warning: Dongle returned invalid value '{value}' for '{key}'")
+                continue
+            combo_box.setCurrentIndex(index)
+            applied += 1
+        self.update_tab_accessibility()
+        self.update_available_channels()
+        return applied
+
+    def parse_config_image(self, response):
+        """Returns {field: value} from a 'get' reply, or None if it has no valid image."""
+        marker = response.find(b"GET: binary config follows")
+        if marker == -1:
+            return None
+        start = response.find(b"\n", marker) + 1
+        end = response.find(b"\x00", start)
+        payload = decode_serial_frame(response[start:end]) if start > 0 and end != -1 else None
+        if (payload is None or len(payload) != 3 + len(CONFIG_FIELDS) or payload[0] != SERIAL_FRAME_CONFIG
+                or payload[1] != CONFIG_IMAGE_VERSION or payload[2] != len(CONFIG_FIELDS)):
+            self.log("Warning: Binary config from dongle is invalid.")
+            return None
+
+        values = dict(zip(CONFIG_FIELDS, payload[3:]))
+        names = {v: k for k, v in PROTOCOL_IDS.items()}
+        values["protocol"] = names.get(values["protocol"], "")
+        return values
+
+    def parse_config_text(self, response):
+        """Returns {field: value} from the text printed by 'config'."""
+        values = {}
+        config_section_started = False
+
+        for line in response.splitlines():
+            line = line.strip()
+
+            # Skip empty lines and error messages
+            if not line or line.startswith("RX:") or line.startswith("ERROR:") or line.startswith("Type 'help'"):
+                continue
+
+            # Look for the start of configuration section
+            if "=== Current Configuration ===" in line:
+                config_section_started = True
+                continue
+
+            # Skip lines until we reach the config section, and section headers
+            if not config_section_started or line.startswith("---") or line.startswith("==="):
+                continue
+
+            if ':' not in line:
+                continue
+
+            key, value = (part.strip() for part in line.split(':', 1))
+            key = key.lower()
+            if key not in self.controls_map:
+                continue
+            if key == 'protocol':
+                values[key] = value.lower()  # Arduino sends uppercase
+            else:
+                try:
+                    values[key] = int(value)
+                except ValueError:
+                    self.log(f"Warning: Could not parse value for '{key}': {value}")
+        return values
 
     # --- Main Feature Slots ---
 
     @Slot()
     def load_from_dongle(self):
-        """Sends 'config' to the dongle and parses the response."""
+        """Reads the configuration with 'get', or with 'config' from older firmware."""
         if not self.open_serial_port():
             return
-            
+
+        self.set_busy(True)
         self.log("Loading configuration from dongle...")
+        self.link.begin_batch()
         # Send a simple test command first to clear any old buffer/input on the Arduino
-        self.send_serial_command("test", read_timeout=100)
-        
-        # Send the actual config command
-        response = self.send_serial_command("config", read_timeout=1000)
-        
-        if not response:
+        self.link.send("test", done=TEST_DONE, timeout_ms=500)
+        self.link.send("get", done=get_done, on_done=self.on_get_reply, timeout_ms=1000)
+
+    def on_get_reply(self, response, ok, rtt):
+        values = self.parse_config_image(response) if ok else None
+        if values is not None:
+            applied = self.apply_loaded_values(values)
+            self.finish_operation(f"Configuration load complete. Updated {applied} settings.")
+            return
+        if not ok:
             self.log("Error: No response from dongle. Is it in config mode?")
             QMessageBox.warning(self, "No Response", "No response from dongle.\nIs it powered on and in configuration mode?")
-            self.serial.close()
+            self.finish_operation("Load from dongle failed. Port closed.")
             return
-            
-        # Parse the response
-        try:
-            lines_parsed = 0
-            config_section_started = False
-            
-            for line in response.splitlines():
-                line = line.strip()
-                
-                # Skip empty lines and error messages
-                if not line or line.startswith("RX:") or line.startswith("ERROR:") or line.startswith("Type 'help'"):
-                    continue
-                
-                # Look for the start of configuration section
-                if "=== Current Configuration ===" in line:
-                    config_section_started = True
-                    continue
-                    
-                # Skip lines until we reach the config section
-                if not config_section_started:
-                    continue
-                
-                # Skip section headers
-                if line.startswith("---") or line.startswith("==="):
-                    continue
-                    
-                if ':' not in line:
-                    continue
-                    
-                parts = line.split(':', 1)
-                if len(parts) != 2:
-                    continue
-                    
-                key = parts[0].strip().lower()
-                value = parts[1].strip()
-                
-                if key in self.controls_map:
-                    # Handle protocol specially (it's text, not a number)
-                    if key == 'protocol':
-                        # Find the protocol in the dropdown by text
-                        protocol_text = value.upper()  # Arduino sends uppercase
-                        index = self.controls_map[key].findText(protocol_text.lower())
-                        if index != -1:
-                            self.controls_map[key].setCurrentIndex(index)
-                            lines_parsed += 1
-                            self.log(f"Loaded protocol: {protocol_text.lower()}")
-                            # Update tab accessibility when protocol is loaded
-                            self.update_tab_accessibility()
-                        else:
-                            self.log(f"Warning: Unknown protocol '{value}' from dongle")
-                    else:
-                        # Handle numeric channel mappings
-                        try:
-                            channel_num = int(value)
-                            combo_box = self.controls_map[key]
-                            
-                            # Find the index corresponding to the channel number (stored in item data)
-                            index = combo_box.findData(channel_num)
-                            
-                            if index != -1:
-                                combo_box.setCurrentIndex(index)
-                                lines_parsed += 1
-                                if channel_num > 0:  # Only log non-zero (enabled) mappings
-                                    self.log(f"Loaded {key}: Channel {channel_num}")
-                            else:
-                                self.log(f"Warning: Dongle returned invalid channel '{channel_num}' for '{key}'")
-                        
-                        except ValueError:
-                            self.log(f"Warning: Could not parse value for '{key}': {value}")
-            
-            self.log(f"Configuration load complete. Updated {lines_parsed} settings.")
-            if lines_parsed == 0:
-                 self.log("Warning: Could not parse any valid settings from dongle response.")
-            
-            # Update available channels after loading
-            self.update_available_channels()
+        self.log("Dongle has no binary 'get', reading the text configuration.")
+        self.link.send("config", done=CONFIG_DONE, on_done=self.on_config_reply, timeout_ms=2000)
 
+    def on_config_reply(self, response, ok, rtt):
+        if not ok:
+            self.log("Error: No response from dongle. Is it in config mode?")
+            QMessageBox.warning(self, "No Response", "No response from dongle.\nIs it powered on and in configuration mode?")
+            self.finish_operation("Load from dongle failed. Port closed.")
+            return
+        try:
+            values = self.parse_config_text(response.decode('utf-8', 'ignore'))
+            applied = self.apply_loaded_values(values)
+            if applied == 0:
+                self.log("Warning: Could not parse any valid settings from dongle response.")
+            self.finish_operation(f"Configuration load complete. Updated {applied} settings.")
         except Exception as e:
             self.log(f"Error parsing dongle response: {e}")
             QMessageBox.critical(self, "Parse Error", f"An error occurred while parsing the dongle's response: {e}")
-            
-        self.serial.close()
-        self.log("Load from dongle complete. Port closed.")
+            self.finish_operation("Load from dongle failed. Port closed.")
 
     @Slot()
     def save_to_dongle(self):
-        """Sends individual 'set' commands for all UI settings to the dongle, then saves."""
+        """Writes all UI settings with one 'put', or with 'set' commands and 'save' on older firmware."""
         
         # Check if protocol is selected
         if self.protocol_combo.currentData() is None:
@@ -487,19 +871,7 @@ class ConfiguratorApp(QMainWindow):
             self.log(f"Protocol: {proto_text}")
             
             # Show all the commands that would be sent
-            commands = []
-            
-            # Add protocol first
-            commands.append(f"set protocol {self.protocol_combo.currentData()}")
-            
-            # Add all other mappings
-            for key, combo_box in self.controls_map.items():
-                if key == 'protocol': # Already handled above
-                    continue
-                    
-                channel_num = combo_box.currentData() # Get data (0-16)
-                commands.append(f"set {key} {channel_num}")
-            
+            commands = self.set_commands()
             commands.append("save")
             
             self.log("Commands that would be sent:")
@@ -518,7 +890,6 @@ class ConfiguratorApp(QMainWindow):
                                      f"This will overwrite the current dongle configuration with:\n\n"
                                      f"Protocol: {proto_text}\n"
                                      f"All current axis and button mappings\n\n"
-                                     f"The dongle will need to be rebooted to apply the new protocol.\n\n"
                                      f"Continue?",
                                      QMessageBox.Yes | QMessageBox.No, QMessageBox.No)
         
@@ -529,62 +900,76 @@ class ConfiguratorApp(QMainWindow):
         if not self.open_serial_port():
             self.log("Save failed: Could not open port.")
             return
-            
-        try:
-            # Send protocol first
-            protocol_data = self.protocol_combo.currentData()
-            protocol_cmd = f"set protocol {protocol_data}"
-            response = self.send_serial_command(protocol_cmd, read_timeout=500)
-            
-            if "ERROR:" in response:
-                raise Exception(f"Protocol setting failed: {response}")
-            
-            # Count total commands for progress
-            total_commands = 1  # protocol already sent
-            commands_sent = 1
-            
-            # Count non-disabled mappings
-            for key, combo_box in self.controls_map.items():
-                if key != 'protocol':
-                    total_commands += 1
-            
-            # Send all other mappings
-            for key, combo_box in self.controls_map.items():
-                if key == 'protocol': # Already handled above
-                    continue
-                    
-                channel_num = combo_box.currentData() # Get data (0-16)
-                set_cmd = f"set {key} {channel_num}"
-                
-                response = self.send_serial_command(set_cmd, read_timeout=500)
-                commands_sent += 1
-                
-                if "ERROR:" in response:
-                    raise Exception(f"Setting {key} failed: {response}")
-                
-                # Update progress
-                self.log(f"Progress: {commands_sent}/{total_commands} commands sent")
-            
-            # Send save command
-            save_response = self.send_serial_command("save", read_timeout=1500)
-            
-            if "ERROR:" in save_response:
-                raise Exception(f"Save to EEPROM failed: {save_response}")
-            
-            self.log("All settings sent and saved to EEPROM.")
-            QMessageBox.information(self, "Success", 
+
+        self.set_busy(True)
+        self.link.begin_batch()
+        values = {key: combo_box.currentData() for key, combo_box in self.controls_map.items()}
+        image = [PROTOCOL_IDS[values["protocol"]]] + [values[key] for key in CONFIG_FIELDS[1:]]
+        payload = bytes([SERIAL_FRAME_CONFIG, CONFIG_IMAGE_VERSION, len(CONFIG_FIELDS)] + image)
+        self.link.send("put", payload=encode_serial_frame(payload), done=PUT_DONE,
+                       on_done=self.on_put_reply, timeout_ms=1500)
+
+    def set_commands(self):
+        """One 'set' line per setting, protocol first."""
+        commands = [f"set protocol {self.protocol_combo.currentData()}"]
+        for key, combo_box in self.controls_map.items():
+            if key != 'protocol':
+                commands.append(f"set {key} {combo_box.currentData()}")
+        return commands
+
+    def on_put_reply(self, response, ok, rtt):
+        text = response.decode('utf-8', 'ignore')
+        if ok and "PUT: OK" in text:
+            self.finish_operation("Configuration written and saved to EEPROM in one transfer.")
+            QMessageBox.information(self, "Success",
                                     f"Configuration saved to dongle!\n\n"
-                                    f"Protocol: {proto_text}\n"
-                                    f"Commands sent: {commands_sent}\n\n"
-                                    f"Note: You may need to switch the dongle to joystick mode\n"
-                                    f"and back to config mode to apply the new protocol.")
+                                    f"Protocol: {self.protocol_combo.currentText()}")
+            return
+        if not ok or "Unknown command" not in text:
+            self.log(f"Error during save: {text.strip() or 'no reply'}")
+            QMessageBox.critical(self, "Save Error", f"The dongle rejected the configuration:\n{text.strip() or 'no reply'}")
+            self.finish_operation("Save to dongle failed. Port closed.")
+            return
 
-        except Exception as e:
-            self.log(f"Error during save: {e}")
-            QMessageBox.critical(self, "Save Error", f"An error occurred while saving: {e}")
+        # Older firmware: pipeline one text command per setting. The frame after
+        # 'put' reached it as a text line; end that line first.
+        self.log("Dongle has no binary 'put', sending one command per setting.")
+        self.link.write_raw(b"\n")
+        self.save_errors = []
+        commands = self.set_commands()
+        for i, command in enumerate(commands):
+            last = i == len(commands) - 1
+            self.link.send(command, done=SET_DONE, timeout_ms=1000,
+                           on_done=lambda r, ok, rtt, c=command, last=last: self.on_set_reply(c, r, ok, last))
 
-        self.serial.close()
-        self.log("Save to dongle complete. Port closed.")
+    def on_set_reply(self, command, response, ok, last):
+        text = response.decode('utf-8', 'ignore')
+        if not ok or "ERROR" in text:
+            self.save_errors.append(f"{command}: {text.strip() or 'no reply'}")
+        if not last:
+            return
+        if self.save_errors:
+            self.log("Errors: " + "; ".join(self.save_errors))
+            QMessageBox.critical(self, "Save Error", "Some settings were rejected, nothing was saved:\n\n" +
+                                 "\n".join(self.save_errors))
+            self.finish_operation("Save to dongle failed. Port closed.")
+            return
+        # Only persist once every setting was accepted
+        self.link.send("save", done=SAVE_DONE, on_done=self.on_save_reply, timeout_ms=2000)
+
+    def on_save_reply(self, response, ok, rtt):
+        text = response.decode('utf-8', 'ignore')
+        if not ok or "ERROR:" in text:
+            self.log(f"Error during save: Save to EEPROM failed: {text.strip() or 'no reply'}")
+            QMessageBox.critical(self, "Save Error", f"Save to EEPROM failed: {text.strip() or 'no reply'}")
+            self.finish_operation("Save to dongle failed. Port closed.")
+            return
+        self.finish_operation("All settings sent and saved to EEPROM.")
+        QMessageBox.information(self, "Success",
+                                f"Configuration saved to dongle!\n\n"
+                                f"Protocol: {self.protocol_combo.currentText()}\n"
+                                f"Note: You may need to switch the dongle to joystick mode\n"
+                                f"and back to config mode to apply the new protocol.")
 
     @Slot()
     def load_from_file(self):
@@ -668,10 +1053,123 @@ class ConfiguratorApp(QMainWindow):
             self.log(f"Error saving file: {e}")
             QMessageBox.critical(self, "File Error", f"Failed to save file: {e}")
 
+    # --- Live Monitor ---
+
+    @Slot()
+    def toggle_monitor(self):
+        """Starts or stops the dongle's binary channel stream."""
+        if self.monitor_state is None:
+            self.start_monitor()
+        else:
+            self.stop_monitor()
+
+    def start_monitor(self):
+        if not self.open_serial_port():
+            return
+        self.monitor_buffer.clear()
+        self.monitor_frames = 0
+        self.monitor_gaps = 0
+        self.monitor_bad = 0
+        self.monitor_sequence = None
+        self.monitor_link_errors = 0
+        self.monitor_rate_start = time.monotonic()
+        self.monitor_rate_frames = 0
+        self.monitor_rate = 0.0
+        self.channel_plot.clear()
+
+        self.monitor_state = 'starting'
+        self.load_dongle_button.setEnabled(False)
+        self.save_dongle_button.setEnabled(False)
+        self.monitor_button.setText("Stop Monitor")
+        self.monitor_status.setText("Starting...")
+        self.link.begin_batch()
+        self.link.send("monitor", done=MONITOR_DONE, on_done=self.on_monitor_started, timeout_ms=1500)
+
+    def on_monitor_started(self, response, ok, rtt):
+        if self.monitor_state != 'starting':
+            return
+        if not ok or b"MONITOR: started" not in response:
+            self.log("Error: Dongle did not start the monitor. Is it in config mode?")
+            self.finish_monitor()
+            return
+        # Everything from here on is the binary stream
+        self.monitor_state = 'streaming'
+        self.monitor_timer.start()
+        self.link.set_raw_handler(self.on_monitor_data)
+
+    def stop_monitor(self):
+        if self.monitor_state != 'streaming':
+            self.finish_monitor()
+            return
+        self.monitor_state = 'stopping'
+        self.link.write_raw(b"stop\n")
+        QTimer.singleShot(1000, self.finish_monitor)
+
+    @Slot()
+    def finish_monitor(self):
+        if self.monitor_state is None:
+            return
+        self.monitor_state = None
+        self.monitor_timer.stop()
+        self.close_serial_port()
+        self.monitor_button.setText("Start Monitor")
+        self.monitor_status.setText("Stopped")
+        self.set_busy(False)
+        self.log("Monitor stopped. Port closed.")
+
+    def on_monitor_data(self, data):
+        self.monitor_buffer += data
+
+        if self.monitor_state == 'stopping':
+            marker = self.monitor_buffer.find(b"MONITOR: stopped")
+            if marker != -1 and self.monitor_buffer.find(b"\n", marker) != -1:
+                end = self.monitor_buffer.find(b"\n", marker)
+                self.log(self.monitor_buffer[marker:end].decode('utf-8', 'ignore').strip())
+                self.finish_monitor()
+                return
+
+        # Every 0x00 ends a frame
+        while True:
+            end = self.monitor_buffer.find(b"\x00")
+            if end == -1:
+                break
+            block = bytes(self.monitor_buffer[:end])
+            del self.monitor_buffer[:end + 1]
+            if not block:
+                continue
+            frame = parse_monitor_frame(block)
+            if frame is None:
+                self.monitor_bad += 1
+                continue
+            sequence, _, link_errors, channels = frame
+            if self.monitor_sequence is not None:
+                self.monitor_gaps += (sequence - self.monitor_sequence - 1) & 0xFF
+            self.monitor_sequence = sequence
+            self.monitor_link_errors = link_errors
+            self.monitor_frames += 1
+            self.monitor_rate_frames += 1
+            self.channel_plot.add_sample(channels)
+
+        # Text lines that never end in a frame delimiter must not pile up
+        if len(self.monitor_buffer) > 4096:
+            self.monitor_buffer.clear()
+
+    @Slot()
+    def refresh_monitor(self):
+        now = time.monotonic()
+        if now - self.monitor_rate_start >= 1.0:
+            self.monitor_rate = self.monitor_rate_frames / (now - self.monitor_rate_start)
+            self.monitor_rate_start = now
+            self.monitor_rate_frames = 0
+        if self.monitor_state == 'streaming':
+            self.monitor_status.setText(
+                f"{self.monitor_rate:.0f} frames/s, {self.monitor_frames} received, "
+                f"{self.monitor_gaps} missed, {self.monitor_bad} bad, link errors {self.monitor_link_errors}")
+        self.channel_plot.update()
+
     def closeEvent(self, event):
         """Ensure serial port is closed when app exits."""
-        if self.serial.isOpen():
-            self.serial.close()
+        self.close_serial_port()
         event.accept()
 
 